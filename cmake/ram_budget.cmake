@@ -0,0 +1,45 @@
+# Relatório de memória do firmware, executado após o link:
+#   cmake -DSIZE_TOOL=<arm-none-eabi-size> -DELF=<firmware.elf> -DRAM_BUDGET=<bytes> -P ram_budget.cmake
+# Soma as seções pelo endereço (SRAM do RP2040 em 0x20000000, flash XIP em
+# 0x10000000) e falha o build se a RAM estática passar de RAM_BUDGET.
+
+execute_process(
+    COMMAND ${SIZE_TOOL} -A -d ${ELF}
+    OUTPUT_VARIABLE size_out
+    RESULT_VARIABLE size_res
+)
+if (NOT size_res EQUAL 0)
+    message(FATAL_ERROR "ram_budget: falha ao executar ${SIZE_TOOL} em ${ELF}")
+endif()
+
+set(ram_bytes 0)
+set(flash_bytes 0)
+set(ram_report "")
+string(REPLACE "\n" ";" size_lines "${size_out}")
+foreach(line IN LISTS size_lines)
+    if (line MATCHES "^(\\.[A-Za-z0-9_.]+)[ \t]+([0-9]+)[ \t]+([0-9]+)")
+        set(section ${CMAKE_MATCH_1})
+        set(bytes ${CMAKE_MATCH_2})
+        set(addr ${CMAKE_MATCH_3})
+        if (bytes EQUAL 0)
+            continue()
+        endif()
+        # 0x20000000 = 536870912, 0x21000000 = 553648128
+        if (addr GREATER_EQUAL 536870912 AND addr LESS 553648128)
+            math(EXPR ram_bytes "${ram_bytes} + ${bytes}")
+            string(APPEND ram_report "  ${section}: ${bytes}\n")
+            # Seções inicializadas também ocupam uma cópia na flash
+            if (section STREQUAL ".data" OR section MATCHES "^\\.scratch_")
+                math(EXPR flash_bytes "${flash_bytes} + ${bytes}")
+            endif()
+        # 0x10000000 = 268435456, 0x11000000 = 285212672
+        elseif (addr GREATER_EQUAL 268435456 AND addr LESS 285212672)
+            math(EXPR flash_bytes "${flash_bytes} + ${bytes}")
+        endif()
+    endif()
+endforeach()
+
+message(STATUS "Memória: flash ${flash_bytes} bytes, RAM ${ram_bytes} de ${RAM_BUDGET} bytes\n${ram_report}")
+if (ram_bytes GREATER RAM_BUDGET)
+    message(FATAL_ERROR "RAM estática (${ram_bytes} bytes) acima do limite SEMAFORO_RAM_BUDGET (${RAM_BUDGET} bytes)")
+endif()
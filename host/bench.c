@@ -0,0 +1,333 @@
+// Benchmarks das primitivas de renderização e saída.
+//
+// Cada linha da saída é um objeto JSON com a mediana de ns/op (de BENCH_REPS
+// execuções), o mínimo e os bytes movidos por operação (bytes do ram_buffer
+// escritos, palavras enviadas ao FIFO do PIO ou bytes enviados pelo I2C).
+// No host roda com o I2C simulado; na placa (SEMAFORO_BENCH=ON) usa o timer
+// de microssegundos e transmite de fato para o display.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ssd1306.h"
+#include "semaforo.h"
+#include "matriz.h"
+#include "painel.h"
+#include "estado.h"
+#include "intersecao.h"
+#include "brilho.h"
+#include "agenda.h"
+
+#if PICO_ON_DEVICE
+#include "hardware/clocks.h"
+#define BENCH_TARGET "rp2040"
+#define BENCH_MIN_NS 200000000ull // 200 ms por execução
+#define I2C_PORT i2c1
+#define I2C_SDA 14
+#define I2C_SCL 15
+
+static uint64_t bench_now_ns(void) {
+    return time_us_64() * 1000u;
+}
+#else
+#include <time.h>
+#define BENCH_TARGET "host"
+#define BENCH_MIN_NS 20000000ull // 20 ms por execução
+#define I2C_PORT NULL
+
+static uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+#endif
+
+#define BENCH_REPS 9
+#define endereco 0x3C
+
+typedef uint64_t (*bench_fn_t)(uint32_t iters); // Retorna os bytes movidos
+
+typedef struct {
+    const char *name;
+    bench_fn_t fn;
+} bench_t;
+
+static ssd1306_t ssd;
+static semaforo_t semaforo;
+static uint32_t frame[NUM_LEDS];
+static volatile uint32_t bench_sink; // Impede que o compilador descarte o trabalho
+
+static uint64_t bench_fill(uint32_t iters) {
+    for (uint32_t i = 0; i < iters; i++) {
+        ssd1306_fill(&ssd, i & 1);
+    }
+    bench_sink += ssd.ram_buffer[1];
+    return (uint64_t)iters * (ssd.bufsize - 1);
+}
+
+static uint64_t bench_pixel(uint32_t iters) {
+    for (uint32_t i = 0; i < iters; i++) {
+        ssd1306_pixel(&ssd, i & 127, (i >> 7) & 63, (i >> 13) & 1);
+    }
+    bench_sink += ssd.ram_buffer[1];
+    return iters; // Leitura-modificação-escrita de um byte
+}
+
+static uint64_t bench_line(uint32_t iters) {
+    for (uint32_t i = 0; i < iters; i++) {
+        if (i & 1) {
+            ssd1306_line(&ssd, 0, 63, 127, 0, true);
+        } else {
+            ssd1306_line(&ssd, 0, 0, 127, 63, false);
+        }
+    }
+    bench_sink += ssd.ram_buffer[1];
+    return (uint64_t)iters * 128; // Um pixel por coluna
+}
+
+static uint64_t bench_draw_string(uint32_t iters) {
+    static const char str[] = "Semaf. Intelig.";
+    for (uint32_t i = 0; i < iters; i++) {
+        ssd1306_draw_string(&ssd, str, 7, 0);
+    }
+    bench_sink += ssd.ram_buffer[1];
+    return (uint64_t)iters * (sizeof(str) - 1) * 8 * 8; // 8x8 pixels por caractere
+}
+
+// Quadro completo do vDisplayTask: composição + envio pelo I2C
+static uint64_t bench_display_frame(uint32_t iters) {
+    uint32_t sent = ssd.bytes_sent;
+    for (uint32_t i = 0; i < iters; i++) {
+        semaforo_step(&semaforo, MODE_NORMAL);
+        painel_render(&ssd, semaforo.mode, semaforo.phase, semaforo.time_remaining_ms);
+        ssd1306_send_data(&ssd);
+    }
+    return ssd.bytes_sent - sent;
+}
+
+// Um tick de 100 ms com o governador: só recompõe e envia quando a chave muda
+static uint64_t bench_display_governed(uint32_t iters) {
+    static uint32_t last_key = UINT32_MAX;
+    uint32_t sent = ssd.bytes_sent;
+    for (uint32_t i = 0; i < iters; i++) {
+        semaforo_step(&semaforo, MODE_NORMAL);
+        uint32_t key = painel_state_key(semaforo.mode, semaforo.phase, semaforo.time_remaining_ms);
+        if (key != last_key) {
+            painel_render(&ssd, semaforo.mode, semaforo.phase, semaforo.time_remaining_ms);
+            ssd1306_send_data(&ssd);
+            last_key = key;
+        }
+    }
+    return ssd.bytes_sent - sent;
+}
+
+static uint64_t bench_matrix_number(uint32_t iters) {
+    uint32_t color = rgb_to_grb(0, 10, 0);
+    for (uint32_t i = 0; i < iters; i++) {
+        matriz_number_frame(frame, i % 6, color);
+        bench_sink += frame[i % NUM_LEDS];
+    }
+    return (uint64_t)iters * sizeof(frame);
+}
+
+static uint64_t bench_phase_step(uint32_t iters) {
+    uint32_t changes = 0;
+    for (uint32_t i = 0; i < iters; i++) {
+        changes += semaforo_step(&semaforo, MODE_NORMAL);
+    }
+    bench_sink += changes;
+    return (uint64_t)iters * sizeof(semaforo_t);
+}
+
+// Um tick do cruzamento: passo do controlador e quadro de todos os segmentos
+static uint64_t bench_intersecao_tick(uint32_t iters) {
+    uint32_t frame[NUM_LEDS];
+    uint32_t changes = 0;
+    for (uint32_t i = 0; i < iters; i++) {
+        changes += intersecao_step(MODE_NORMAL);
+        intersecao_compose_frame(frame);
+    }
+    bench_sink += changes + frame[0];
+    return (uint64_t)iters * sizeof(frame);
+}
+
+// Trabalho de CPU do brilho adaptativo por tick: filtro e histerese sobre uma
+// rampa de luz (a média do anel do DMA não entra aqui)
+static uint64_t bench_brilho_update(uint32_t iters) {
+    brilho_t b;
+    brilho_init(&b);
+    uint32_t changes = 0;
+    for (uint32_t i = 0; i < iters; i++) {
+        changes += brilho_update(&b, (uint16_t)(i & 0xFFF));
+    }
+    bench_sink += changes + brilho_leds(b.nivel);
+    return (uint64_t)iters * sizeof(brilho_t);
+}
+
+// Escalonador das saídas: quatro protothreads com os períodos do firmware
+// (botão, LED RGB, bipe do amarelo, display) e um evento de estado a cada
+// TICK_MS. Cada operação é uma acordada da tarefa, no prazo devolvido pela agenda.
+static agenda_t bench_agenda;
+static agenda_pt_t bench_pts[4];
+static const uint32_t bench_periodos[4] = {50, 100, 428, 1000};
+
+static int bench_pt(agenda_pt_t *p) {
+    PT_BEGIN(&p->pt);
+    while (true) {
+        bench_sink++;
+        AGENDA_ESPERAR(p, bench_periodos[p - bench_pts]);
+    }
+    PT_END(&p->pt);
+}
+
+static uint64_t bench_agenda_wake(uint32_t iters) {
+    agenda_init(&bench_agenda, 0);
+    for (int i = 0; i < 4; i++) {
+        agenda_add(&bench_agenda, &bench_pts[i], bench_pt, 1, "bench");
+    }
+    uint32_t agora = 0, proximo_tick = TICK_MS;
+    for (uint32_t i = 0; i < iters; i++) {
+        uint32_t eventos = 0;
+        if (agora >= proximo_tick) {
+            eventos = 1;
+            proximo_tick += TICK_MS;
+        }
+        uint32_t espera = agenda_executar(&bench_agenda, agora, eventos);
+        uint32_t ate_tick = proximo_tick - agora;
+        agora += espera < ate_tick ? espera : ate_tick;
+    }
+    bench_sink += bench_agenda.passadas;
+    return (uint64_t)iters * sizeof(roda_t);
+}
+
+static estado_pub_t estado;
+
+// Leitura sem concorrência: custo base do seqlock
+static uint64_t bench_estado_read(uint32_t iters) {
+    estado_t e;
+    for (uint32_t i = 0; i < iters; i++) {
+        estado_read(&estado, &e);
+        bench_sink += e.time_remaining_ms;
+    }
+    return (uint64_t)iters * sizeof(estado_t);
+}
+
+#if !PICO_ON_DEVICE
+#include <pthread.h>
+
+// Leitura com um escritor publicando sem parar: custo das releituras. A
+// conferência dos instantâneos fica no teste estado_seqlock (ctest).
+static volatile bool contended_stop;
+
+static void *contended_writer(void *arg) {
+    (void)arg;
+    estado_t e = {0};
+    while (!contended_stop) {
+        e.time_remaining_ms++;
+        estado_publish(&estado, &e);
+    }
+    return NULL;
+}
+
+static uint64_t bench_estado_read_contended(uint32_t iters) {
+    pthread_t writer;
+    contended_stop = false;
+    pthread_create(&writer, NULL, contended_writer, NULL);
+    estado_t e;
+    for (uint32_t i = 0; i < iters; i++) {
+        bench_sink += estado_read(&estado, &e);
+    }
+    contended_stop = true;
+    pthread_join(writer, NULL);
+    return (uint64_t)iters * sizeof(estado_t);
+}
+#endif
+
+static const bench_t benches[] = {
+    {"ssd1306_fill", bench_fill},
+    {"ssd1306_pixel", bench_pixel},
+    {"ssd1306_line", bench_line},
+    {"ssd1306_draw_string", bench_draw_string},
+    {"display_frame", bench_display_frame},
+    {"display_governed_tick", bench_display_governed},
+    {"matrix_number_frame", bench_matrix_number},
+    {"phase_step", bench_phase_step},
+    {"intersecao_tick", bench_intersecao_tick},
+    {"brilho_update", bench_brilho_update},
+    {"agenda_wake", bench_agenda_wake},
+    {"estado_read", bench_estado_read},
+#if !PICO_ON_DEVICE
+    {"estado_read_contended", bench_estado_read_contended},
+#endif
+};
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void bench_run(const bench_t *b) {
+    // Calibração: dobra as iterações até uma execução durar BENCH_MIN_NS
+    uint32_t iters = 1;
+    while (true) {
+        uint64_t t0 = bench_now_ns();
+        b->fn(iters);
+        if (bench_now_ns() - t0 >= BENCH_MIN_NS || iters >= (1u << 30)) break;
+        iters *= 2;
+    }
+
+    double ns_per_op[BENCH_REPS];
+    uint64_t bytes = 0;
+    for (int r = 0; r < BENCH_REPS; r++) {
+        uint64_t t0 = bench_now_ns();
+        bytes = b->fn(iters);
+        ns_per_op[r] = (double)(bench_now_ns() - t0) / iters;
+    }
+    qsort(ns_per_op, BENCH_REPS, sizeof(double), compare_double);
+
+    double median = ns_per_op[BENCH_REPS / 2];
+    double bytes_per_op = (double)bytes / iters;
+    printf("{\"target\":\"%s\",\"bench\":\"%s\",\"iters\":%lu,\"ns_per_op\":%.2f,\"min_ns_per_op\":%.2f,"
+           "\"bytes_per_op\":%.1f,\"mb_per_s\":%.2f",
+           BENCH_TARGET, b->name, (unsigned long)iters, median, ns_per_op[0],
+           bytes_per_op, median > 0 ? bytes_per_op * 1000.0 / median : 0.0);
+#if PICO_ON_DEVICE
+    printf(",\"cycles_per_op\":%.1f", median * clock_get_hz(clk_sys) / 1e9);
+#endif
+    printf("}\n");
+}
+
+int main(int argc, char **argv) {
+#if PICO_ON_DEVICE
+    stdio_init_all();
+    sleep_ms(3000); // Tempo para o host abrir a serial USB
+    i2c_init(I2C_PORT, 400 * 1000);
+    gpio_set_function(I2C_SDA, GPIO_FUNC_I2C);
+    gpio_set_function(I2C_SCL, GPIO_FUNC_I2C);
+    gpio_pull_up(I2C_SDA);
+    gpio_pull_up(I2C_SCL);
+#endif
+    ssd1306_init(&ssd, WIDTH, HEIGHT, false, endereco, I2C_PORT);
+    semaforo_start(&semaforo, MODE_NORMAL, semaforo_plano(MODE_NORMAL));
+    intersecao_start(MODE_NORMAL);
+
+#if PICO_ON_DEVICE
+    const char *filter = NULL; // O crt0 do SDK não repassa argc/argv
+    (void)argc;
+    (void)argv;
+#else
+    const char *filter = argc > 1 ? argv[1] : NULL; // Executa só os benchmarks que contêm o filtro
+#endif
+    for (size_t i = 0; i < sizeof(benches) / sizeof(benches[0]); i++) {
+        if (filter == NULL || strstr(benches[i].name, filter) != NULL) {
+            bench_run(&benches[i]);
+        }
+    }
+
+#if PICO_ON_DEVICE
+    while (true) {
+        tight_loop_contents();
+    }
+#else
+    return 0;
+#endif
+}
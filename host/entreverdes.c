@@ -0,0 +1,145 @@
+// Teste dos entreverdes do cruzamento nas trocas de modo e na preempção.
+//
+// Para cada par de modos (planos e noturno) e cada instante do ciclo (tick a
+// tick), o cruzamento troca de modo e, em parte das sequências, troca de novo
+// logo depois, no meio da transição. Outra bateria pede a preempção em cada
+// instante do ciclo, por durações diferentes, com e sem troca para o noturno.
+// A cada tick o teste confere, grupo a grupo:
+//   - o verde só termina pelo amarelo, e o amarelo dura o configurado;
+//   - um verde só abre depois dos entreverdes de cada grupo conflitante,
+//     contados do fim do verde dele;
+//   - o piscante do noturno só começa depois de todos os grupos cumprirem os
+//     entreverdes para os conflitantes;
+//   - dois grupos em conflito nunca ficam em verde ao mesmo tempo;
+//   - ao fim da sequência, o modo pedido está em vigor.
+// Retorna 1 se alguma verificação falhar.
+//
+//   intersecao_entreverdes
+#include <stdio.h>
+#include "intersecao.h"
+#include "semaforo.h"
+
+#define MAX_GRUPOS 8
+#define CICLO_TICKS 600 // Cobre o ciclo mais longo, com as transições
+#define DEPOIS_TICKS 900 // Observação após a troca
+#define MAX_IMPRESSAS 10
+
+static const uint8_t modos_teste[] = {MODE_NORMAL, MODE_NOTURNO, MODE_ALTO_FLUXO, MODE_BAIXO_FLUXO};
+#define NUM_MODOS_TESTE (sizeof(modos_teste) / sizeof(modos_teste[0]))
+// Segunda troca, em ticks após a primeira (0 = sem segunda troca)
+static const uint32_t segunda[] = {0, 1, 5, 20, 35};
+#define NUM_SEGUNDA (sizeof(segunda) / sizeof(segunda[0]))
+// Duração da preempção, em ticks
+static const uint32_t preempcoes[] = {1, 10, 50, 120};
+#define NUM_PREEMPCOES (sizeof(preempcoes) / sizeof(preempcoes[0]))
+
+static bool piscante(uint8_t fase) {
+    return fase == PHASE_PISCANTE_ACESO || fase == PHASE_PISCANTE_APAGADO;
+}
+
+static uint32_t falhas;
+
+static void falha(const char *o_que, uint32_t t_ms, uint8_t g, uint32_t medido, uint32_t minimo,
+                  const uint8_t modos[3], uint32_t troca, uint32_t troca2) {
+    if (falhas++ < MAX_IMPRESSAS) {
+        printf("{\"falha\":\"%s\",\"t_ms\":%u,\"grupo\":\"%s\",\"medido_ms\":%u,\"minimo_ms\":%u,"
+               "\"modos\":[%u,%u,%u],\"troca_ms\":%u,\"troca2_ms\":%u}\n",
+               o_que, t_ms, intersecao_nome(g), medido, minimo, modos[0], modos[1], modos[2],
+               troca * TICK_MS, troca2 * TICK_MS);
+    }
+}
+
+// Roda uma sequência: modos[0] até a troca, modos[1] até troca2 e modos[2]
+// depois; a preempção fica pedida de troca até troca + preempcao (0 = sem)
+static void sequencia(const uint8_t modos[3], uint32_t troca, uint32_t troca2, uint32_t preempcao) {
+    uint8_t n = intersecao_num_grupos();
+    uint8_t fase[MAX_GRUPOS];
+    uint32_t fim_verde[MAX_GRUPOS];
+    uint32_t inicio_amarelo[MAX_GRUPOS] = {0};
+    bool ja_abriu[MAX_GRUPOS] = {false};
+
+    intersecao_start(modos[0]);
+    for (uint8_t g = 0; g < n; g++) fase[g] = intersecao_phase(g);
+
+    for (uint32_t tick = 1; tick <= troca + DEPOIS_TICKS; tick++) {
+        uint32_t t_ms = tick * TICK_MS;
+        if (preempcao != 0 && (tick == troca || tick == troca + preempcao)) {
+            intersecao_preempt(tick == troca);
+        }
+        intersecao_step(tick < troca ? modos[0] : tick < troca2 ? modos[1] : modos[2]);
+        for (uint8_t g = 0; g < n; g++) {
+            uint8_t f = intersecao_phase(g);
+            if (fase[g] == PHASE_VERDE && f != PHASE_VERDE) {
+                if (f != PHASE_AMARELO) falha("verde_sem_amarelo", t_ms, g, 0, intersecao_amarelo_ms(g), modos, troca, troca2);
+                fim_verde[g] = t_ms;
+                ja_abriu[g] = true;
+            }
+            if (fase[g] != PHASE_AMARELO && f == PHASE_AMARELO) inicio_amarelo[g] = t_ms;
+            if (fase[g] == PHASE_AMARELO && f == PHASE_VERMELHO && t_ms - inicio_amarelo[g] < intersecao_amarelo_ms(g)) {
+                falha("amarelo_curto", t_ms, g, t_ms - inicio_amarelo[g], intersecao_amarelo_ms(g), modos, troca, troca2);
+            }
+            if (!piscante(fase[g]) && piscante(f)) {
+                for (uint8_t e = 0; e < n; e++) {
+                    for (uint8_t c = 0; c < n; c++) {
+                        uint16_t minimo = intersecao_entreverdes_ms(e, c);
+                        if (minimo != 0 && ja_abriu[e] && t_ms - fim_verde[e] < minimo) {
+                            falha("piscante_sem_entreverdes", t_ms, e, t_ms - fim_verde[e], minimo, modos, troca, troca2);
+                        }
+                    }
+                }
+            }
+            if (fase[g] != PHASE_VERDE && f == PHASE_VERDE) {
+                for (uint8_t e = 0; e < n; e++) {
+                    uint16_t minimo = intersecao_entreverdes_ms(e, g);
+                    if (minimo != 0 && ja_abriu[e] && t_ms - fim_verde[e] < minimo) {
+                        falha("entreverdes_curto", t_ms, g, t_ms - fim_verde[e], minimo, modos, troca, troca2);
+                    }
+                }
+            }
+            fase[g] = f;
+        }
+        for (uint8_t a = 0; a < n; a++) {
+            for (uint8_t b = a + 1; b < n; b++) {
+                if (fase[a] == PHASE_VERDE && fase[b] == PHASE_VERDE && intersecao_entreverdes_ms(a, b) != 0) {
+                    falha("verdes_em_conflito", t_ms, b, 0, 0, modos, troca, troca2);
+                }
+            }
+        }
+    }
+    if (intersecao_mode() != modos[2]) {
+        falha("modo_nao_aplicado", (troca + DEPOIS_TICKS) * TICK_MS, 0, intersecao_mode(), modos[2], modos, troca, troca2);
+    }
+}
+
+int main(void) {
+    uint32_t sequencias = 0;
+    for (uint32_t i = 0; i < NUM_MODOS_TESTE; i++) {
+        for (uint32_t j = 0; j < NUM_MODOS_TESTE; j++) {
+            if (i == j) continue;
+            for (uint32_t k = 0; k < NUM_SEGUNDA; k++) {
+                // Segunda troca: volta ao modo de origem
+                uint8_t modos[3] = {modos_teste[i], modos_teste[j], segunda[k] ? modos_teste[i] : modos_teste[j]};
+                for (uint32_t troca = 1; troca <= CICLO_TICKS; troca++) {
+                    sequencia(modos, troca, troca + segunda[k], 0);
+                    sequencias++;
+                }
+            }
+        }
+    }
+    // Preempção em cada instante do ciclo; com o noturno pedido no mesmo tick,
+    // a troca espera a liberação
+    for (uint32_t i = 0; i < NUM_MODOS_TESTE; i++) {
+        for (uint32_t k = 0; k < NUM_PREEMPCOES; k++) {
+            for (uint32_t noturno = 0; noturno < 2; noturno++) {
+                uint8_t destino = noturno ? MODE_NOTURNO : modos_teste[i];
+                uint8_t modos[3] = {modos_teste[i], destino, destino};
+                for (uint32_t troca = 1; troca <= CICLO_TICKS; troca++) {
+                    sequencia(modos, troca, troca, preempcoes[k]);
+                    sequencias++;
+                }
+            }
+        }
+    }
+    printf("{\"teste\":\"entreverdes\",\"sequencias\":%u,\"falhas\":%u}\n", sequencias, falhas);
+    return falhas != 0;
+}
@@ -0,0 +1,245 @@
+// Regressão da renderização contra quadros de referência (golden).
+//
+// O escalonador de fases roda um ciclo completo de cada modo em tempo simulado.
+// No início, a cada troca de fase e a cada segundo, o programa compõe o
+// ram_buffer do SSD1306 (painel_render) e o quadro WS2812 (matriz_compose_frame),
+// e compara os dois byte a byte com os de host/golden. Cada quadro diferente
+// vira imagens em --diff: PBM do display (esperado | obtido | diferença) e PPM
+// da matriz (esperado | obtido).
+//
+//   semaforo_golden [--diff DIR]   compara; retorna 1 se algum quadro mudou
+//   semaforo_golden --gerar        regrava as referências (só depois de conferir os diffs)
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "semaforo.h"
+#include "matriz.h"
+#include "painel.h"
+
+#ifndef GOLDEN_DIR
+#define GOLDEN_DIR "golden"
+#endif
+
+#define LARGURA 128
+#define ALTURA 64 // Display do firmware (DISPLAY_HEIGHT)
+#define BUFSIZE (LARGURA * ALTURA / 8 + 1) // ram_buffer com o byte de controle 0x40
+#define MAX_QUADROS 128
+#define LED_PX 8 // Lado de cada LED na imagem da matriz
+#define MARGEM 4 // Separação entre os painéis das imagens
+
+// Um instante capturado, gravado cru nos arquivos de referência (host
+// little-endian). Os campos de estado entram na comparação: se o roteiro do
+// escalonador mudar, o quadro não corresponde mais à referência.
+typedef struct {
+    uint32_t t_ms;
+    uint32_t time_remaining_ms;
+    uint8_t phase;
+    uint8_t display[BUFSIZE];
+    uint8_t matriz[NUM_LEDS * 4]; // Palavras do FIFO do PIO em little-endian
+} quadro_t;
+
+static const char *const arquivos[NUM_MODES] = {
+    [MODE_NORMAL] = "normal",
+    [MODE_NOTURNO] = "noturno",
+    [MODE_ALTO_FLUXO] = "alto_fluxo",
+    [MODE_BAIXO_FLUXO] = "baixo_fluxo",
+};
+
+static quadro_t obtidos[MAX_QUADROS];
+static quadro_t esperados[MAX_QUADROS];
+
+static void capturar(ssd1306_t *ssd, const semaforo_t *s, uint32_t t_ms, quadro_t *q) {
+    uint32_t frame[NUM_LEDS];
+    memset(q, 0, sizeof(*q));
+    q->t_ms = t_ms;
+    q->time_remaining_ms = s->time_remaining_ms;
+    q->phase = s->phase;
+    painel_render(ssd, s->mode, s->phase, s->time_remaining_ms);
+    memcpy(q->display, ssd->ram_buffer, BUFSIZE);
+    matriz_compose_frame(frame, s->phase, s->time_remaining_ms);
+    for (int i = 0; i < NUM_LEDS; i++) {
+        for (int b = 0; b < 4; b++) {
+            q->matriz[i * 4 + b] = (uint8_t)(frame[i] >> (8 * b));
+        }
+    }
+}
+
+// Um ciclo do plano do modo: início, trocas de fase e cada segundo
+static uint32_t renderizar(ssd1306_t *ssd, uint8_t mode, quadro_t *q) {
+    semaforo_t s;
+    const plano_t *plano = semaforo_plano(mode);
+    uint32_t ciclo = 0;
+    for (uint8_t i = 0; i < plano->num_etapas; i++) {
+        ciclo += plano->etapas[i].ticks;
+    }
+
+    semaforo_start(&s, mode, plano);
+    uint32_t n = 0;
+    bool mudou = true;
+    for (uint32_t tick = 0; tick < ciclo && n < MAX_QUADROS; tick++) {
+        uint32_t t_ms = tick * TICK_MS;
+        if (mudou || t_ms % 1000 == 0) {
+            capturar(ssd, &s, t_ms, &q[n++]);
+        }
+        mudou = semaforo_step(&s, mode);
+    }
+    return n;
+}
+
+static void caminho(char *buf, size_t tam, const char *dir, const char *nome, const char *ext) {
+    snprintf(buf, tam, "%s/%s%s", dir, nome, ext);
+}
+
+static bool gravar(const char *nome, const quadro_t *q, uint32_t n) {
+    char arq[512];
+    caminho(arq, sizeof(arq), GOLDEN_DIR, nome, ".bin");
+    FILE *f = fopen(arq, "wb");
+    if (f == NULL || fwrite(q, sizeof(*q), n, f) != n) {
+        perror(arq);
+        if (f != NULL) fclose(f);
+        return false;
+    }
+    fclose(f);
+    return true;
+}
+
+static int ler(const char *nome, quadro_t *q) {
+    char arq[512];
+    caminho(arq, sizeof(arq), GOLDEN_DIR, nome, ".bin");
+    FILE *f = fopen(arq, "rb");
+    if (f == NULL) {
+        perror(arq);
+        return -1;
+    }
+    size_t n = fread(q, sizeof(*q), MAX_QUADROS, f);
+    fclose(f);
+    return (int)n;
+}
+
+// Mesmo endereçamento de ssd1306_pixel: 8 páginas por coluna
+static bool aceso(const uint8_t *buf, int x, int y) {
+    return (buf[(y >> 3) + (x << 3) + 1] >> (y & 7)) & 1;
+}
+
+// PBM com 1 = preto: pixel aceso do OLED sai escuro no papel
+static void diff_display(const char *dir, const char *nome, const quadro_t *e, const quadro_t *o) {
+    char arq[512];
+    snprintf(arq, sizeof(arq), "%s/%s_%05u_display.pbm", dir, nome, o->t_ms);
+    FILE *f = fopen(arq, "wb");
+    if (f == NULL) {
+        perror(arq);
+        return;
+    }
+    int largura = 3 * LARGURA + 2 * MARGEM;
+    fprintf(f, "P4\n%d %d\n", largura, ALTURA);
+    for (int y = 0; y < ALTURA; y++) {
+        uint8_t linha[(3 * LARGURA + 2 * MARGEM + 7) / 8] = {0};
+        for (int x = 0; x < LARGURA; x++) {
+            bool a = aceso(e->display, x, y);
+            bool b = aceso(o->display, x, y);
+            int px[3] = {x, LARGURA + MARGEM + x, 2 * (LARGURA + MARGEM) + x};
+            bool v[3] = {a, b, a != b};
+            for (int k = 0; k < 3; k++) {
+                if (v[k]) linha[px[k] / 8] |= 0x80 >> (px[k] % 8);
+            }
+        }
+        fwrite(linha, 1, sizeof(linha), f);
+    }
+    fclose(f);
+}
+
+// PPM: LEDs na ordem da cadeia, 5 por linha; o branco é a maior intensidade dos dois quadros
+static void diff_matriz(const char *dir, const char *nome, const quadro_t *e, const quadro_t *o) {
+    char arq[512];
+    snprintf(arq, sizeof(arq), "%s/%s_%05u_matriz.ppm", dir, nome, o->t_ms);
+    FILE *f = fopen(arq, "wb");
+    if (f == NULL) {
+        perror(arq);
+        return;
+    }
+    const quadro_t *q[2] = {e, o};
+    uint8_t max = 1;
+    for (int k = 0; k < 2; k++) {
+        for (int i = 0; i < NUM_LEDS * 4; i++) {
+            if (i % 4 != 0 && q[k]->matriz[i] > max) max = q[k]->matriz[i]; // Byte 0 é o alinhamento
+        }
+    }
+    int lado = 5 * LED_PX;
+    fprintf(f, "P6\n%d %d\n%u\n", 2 * lado + MARGEM, lado, max);
+    for (int y = 0; y < lado; y++) {
+        for (int x = 0; x < 2 * lado + MARGEM; x++) {
+            uint8_t rgb[3] = {0, 0, 0};
+            int painel = x < lado ? 0 : x >= lado + MARGEM ? 1 : -1;
+            if (painel >= 0) {
+                int col = (x - painel * (lado + MARGEM)) / LED_PX;
+                const uint8_t *w = &q[painel]->matriz[((y / LED_PX) * 5 + col) * 4];
+                rgb[0] = w[2]; // GRB << 8: byte 3 = G, 2 = R, 1 = B
+                rgb[1] = w[3];
+                rgb[2] = w[1];
+            }
+            fwrite(rgb, 1, 3, f);
+        }
+    }
+    fclose(f);
+}
+
+static uint32_t comparar(const char *dir, uint8_t mode, uint32_t n_obtidos, int n_esperados) {
+    uint32_t diferentes = 0;
+    uint32_t n = n_obtidos < (uint32_t)n_esperados ? n_obtidos : (uint32_t)n_esperados;
+    for (uint32_t i = 0; i < n; i++) {
+        const quadro_t *e = &esperados[i];
+        const quadro_t *o = &obtidos[i];
+        bool estado = e->t_ms == o->t_ms && e->phase == o->phase && e->time_remaining_ms == o->time_remaining_ms;
+        bool display = memcmp(e->display, o->display, BUFSIZE) == 0;
+        bool matriz = memcmp(e->matriz, o->matriz, sizeof(e->matriz)) == 0;
+        if (estado && display && matriz) continue;
+        diferentes++;
+        printf("{\"golden\":\"%s\",\"t_ms\":%u,\"fase\":%u,\"restante_ms\":%u,\"estado\":%s,\"display\":%s,"
+               "\"matriz\":%s}\n",
+               arquivos[mode], o->t_ms, o->phase, o->time_remaining_ms, estado ? "true" : "false",
+               display ? "true" : "false", matriz ? "true" : "false");
+        if (!display) diff_display(dir, arquivos[mode], e, o);
+        if (!matriz) diff_matriz(dir, arquivos[mode], e, o);
+    }
+    return diferentes + (n_obtidos > n ? n_obtidos - n : (uint32_t)n_esperados - n); // Quadros a mais ou a menos
+}
+
+int main(int argc, char **argv) {
+    bool gerar = false;
+    const char *dir_diff = "golden_diff";
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--gerar") == 0) gerar = true;
+        else if (strcmp(argv[i], "--diff") == 0 && i + 1 < argc) dir_diff = argv[++i];
+    }
+    const char *dir = gerar ? GOLDEN_DIR : dir_diff;
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST) {
+        perror(dir);
+        return 2;
+    }
+
+    // Um só display para todos os modos, como no firmware: resto de um quadro anterior também conta
+    ssd1306_t ssd;
+    ssd1306_init(&ssd, LARGURA, ALTURA, false, 0x3C, NULL);
+
+    uint32_t total = 0;
+    for (uint8_t mode = 0; mode < NUM_MODES; mode++) {
+        uint32_t n = renderizar(&ssd, mode, obtidos);
+        if (gerar) {
+            if (!gravar(arquivos[mode], obtidos, n)) return 2;
+            printf("{\"golden\":\"%s\",\"quadros\":%u,\"gerado\":true}\n", arquivos[mode], n);
+            continue;
+        }
+        int esperados_n = ler(arquivos[mode], esperados);
+        if (esperados_n < 0) return 2;
+        uint32_t diferentes = comparar(dir_diff, mode, n, esperados_n);
+        printf("{\"golden\":\"%s\",\"quadros\":%u,\"diferentes\":%u}\n", arquivos[mode], n, diferentes);
+        total += diferentes;
+    }
+    if (!gerar && total > 0) {
+        printf("{\"golden\":\"falhou\",\"diferentes\":%u,\"diff\":\"%s\"}\n", total, dir_diff);
+        return 1;
+    }
+    return 0;
+}
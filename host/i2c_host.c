@@ -0,0 +1,10 @@
+#include "hardware/i2c.h"
+
+// Barramento I2C simulado: aceita todos os bytes, como um escravo sempre pronto
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+    (void)i2c;
+    (void)addr;
+    (void)src;
+    (void)nostop;
+    return (int)len;
+}
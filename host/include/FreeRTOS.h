@@ -0,0 +1,16 @@
+// Substituto mínimo do FreeRTOS.h: só o configASSERT, que no host aborta
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define configASSERT(x)                                                  \
+    do {                                                                 \
+        if (!(x)) {                                                      \
+            fprintf(stderr, "configASSERT: %s:%d\n", __FILE__, __LINE__); \
+            abort();                                                     \
+        }                                                                \
+    } while (0)
+
+#endif
@@ -0,0 +1,11 @@
+// Substituto mínimo do pico/stdlib.h para compilar a lógica no host
+#ifndef HOST_PICO_STDLIB_H
+#define HOST_PICO_STDLIB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef unsigned int uint;
+
+#endif
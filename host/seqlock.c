@@ -0,0 +1,65 @@
+// Teste de estresse do seqlock do estado do controlador (estado_publish/estado_read).
+//
+// Uma thread escritora publica sem parar estados em que todos os campos
+// derivam do mesmo contador, e a thread principal confere cada instantâneo:
+//   - os campos vêm todos da mesma publicação (nenhuma leitura rasgada);
+//   - o contador nunca volta (nenhum instantâneo velho depois de um novo).
+// Retorna 1 se alguma leitura falhar ou se a escritora não chegar a publicar.
+//
+//   estado_seqlock [leituras]
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "estado.h"
+#include "semaforo.h"
+
+#define LEITURAS 20000000u
+
+static estado_pub_t estado;
+static volatile bool parar;
+static uint64_t escritas;
+
+static void gerar(uint32_t n, estado_t *e) {
+    e->mode = n % NUM_MODES;
+    e->phase = n % 5;
+    e->time_remaining_ms = n;
+}
+
+static void *escritora(void *arg) {
+    (void)arg;
+    uint32_t n = 0;
+    estado_t e;
+    while (!parar) {
+        gerar(++n, &e);
+        estado_publish(&estado, &e);
+    }
+    escritas = n;
+    return NULL;
+}
+
+int main(int argc, char **argv) {
+    uint32_t leituras = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 10) : LEITURAS;
+    pthread_t t;
+    parar = false;
+    pthread_create(&t, NULL, escritora, NULL);
+
+    uint64_t rasgadas = 0, regressoes = 0, releituras = 0, novas = 0;
+    uint32_t anterior = 0;
+    estado_t e, esperado;
+    for (uint32_t i = 0; i < leituras; i++) {
+        releituras += estado_read(&estado, &e);
+        gerar(e.time_remaining_ms, &esperado);
+        if (e.mode != esperado.mode || e.phase != esperado.phase) rasgadas++;
+        if (e.time_remaining_ms < anterior) regressoes++;
+        if (e.time_remaining_ms != anterior) novas++;
+        anterior = e.time_remaining_ms;
+    }
+    parar = true;
+    pthread_join(t, NULL);
+
+    printf("{\"teste\":\"estado_seqlock\",\"leituras\":%u,\"escritas\":%llu,\"instantaneos_novos\":%llu,"
+           "\"releituras\":%llu,\"rasgadas\":%llu,\"regressoes\":%llu}\n",
+           leituras, (unsigned long long)escritas, (unsigned long long)novas, (unsigned long long)releituras,
+           (unsigned long long)rasgadas, (unsigned long long)regressoes);
+    return rasgadas != 0 || regressoes != 0 || novas == 0;
+}
@@ -0,0 +1,391 @@
+// Microssimulação de tráfego para avaliar planos de tempo.
+//
+// O escalonador de fases do firmware (semaforo_step) roda contra duas filas:
+// a via principal descarrega no verde e a transversal no vermelho da principal;
+// o amarelo é tempo perdido para as duas. As chegadas são de Bernoulli por tick
+// (aproximação de Poisson) e a descarga segue o fluxo de saturação, com perda
+// inicial no começo de cada verde.
+//
+// Todas as combinações de verde/vermelho da varredura, em cada cenário de
+// demanda e em cada réplica, viram tarefas independentes distribuídas entre os
+// núcleos por um pool com roubo de trabalho. Cada tarefa tem a própria semente
+// (derivada de --seed e do índice) e grava num slot fixo, então o resultado não
+// depende do número de threads nem da ordem de execução.
+//
+//   semaforo_sim [--seed N] [--threads N] [--reps N]
+//
+// Com --energia roda cada modo por uma hora simulada com os contadores de
+// lib/energia.h (matriz, LED RGB, buzzers e bytes I2C do display) e imprime o
+// consumo estimado. A CPU não é simulada: só a medição na placa ('P') tem esse dado.
+//
+//   semaforo_sim --energia
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "semaforo.h"
+#include "matriz.h"
+#include "painel.h"
+#include "energia.h"
+
+#define SIM_HORAS 1
+#define SIM_TICKS (SIM_HORAS * 3600 * 1000 / TICK_MS)
+#define SATURACAO_VEH_H 1800 // Fluxo de saturação por aproximação (1 veículo a cada 2 s)
+#define PERDA_INICIAL_MS 2000 // Reação da fila no início do verde
+#define AMARELO_S 3
+
+#define VARREDURA_MIN_S 10
+#define VARREDURA_MAX_S 40
+#define VARREDURA_N (VARREDURA_MAX_S - VARREDURA_MIN_S + 1)
+#define NUM_PLANOS (VARREDURA_N * VARREDURA_N)
+#define MELHORES 3
+
+typedef struct {
+    const char *nome;
+    uint32_t principal_veh_h;
+    uint32_t transversal_veh_h;
+} cenario_t;
+
+static const cenario_t cenarios[] = {
+    {"equilibrado", 600, 600},
+    {"principal_carregada", 900, 400},
+    {"transversal_carregada", 400, 900},
+};
+#define NUM_CENARIOS (sizeof(cenarios) / sizeof(cenarios[0]))
+
+// Planos do firmware, para comparar com a varredura
+typedef struct {
+    const char *nome;
+    uint8_t verde_s;
+    uint8_t vermelho_s;
+} plano_nomeado_t;
+
+static const plano_nomeado_t planos_firmware[] = {
+    {"Normal", 20, 20},
+    {"Alto Fluxo", 25, 15},
+    {"Baixo Fluxo", 15, 25},
+};
+
+typedef struct {
+    uint32_t chegadas;
+    uint32_t partidas;
+    uint64_t fila_ticks; // Soma da fila em cada tick (veículo x tick de espera)
+    uint32_t fila_max;
+} resultado_t;
+
+static uint32_t reps = 10;
+static uint64_t semente = 1;
+static resultado_t *resultados; // [cenário][plano][réplica]
+static uint32_t num_tarefas;
+
+// splitmix64: semente independente por tarefa, gerador rápido e reprodutível
+static uint64_t splitmix64(uint64_t *s) {
+    uint64_t z = (*s += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Probabilidade de chegada por tick em 32 bits de ponto fixo
+static uint32_t prob_tick(uint32_t veh_h) {
+    return (uint32_t)((uint64_t)veh_h * TICK_MS * 0x100000000ull / 3600000ull);
+}
+
+typedef struct {
+    uint32_t fila;
+    uint32_t credito_ms; // Tempo de verde acumulado para a próxima descarga
+    uint32_t verde_ms;   // Tempo desde o início do verde
+} aproximacao_t;
+
+static void aproximacao_tick(aproximacao_t *a, bool verde, resultado_t *r) {
+    if (!verde) {
+        a->verde_ms = 0;
+        a->credito_ms = 0;
+        return;
+    }
+    a->verde_ms += TICK_MS;
+    if (a->verde_ms <= PERDA_INICIAL_MS) return;
+    a->credito_ms += TICK_MS;
+    uint32_t headway_ms = 3600000u / SATURACAO_VEH_H;
+    if (a->credito_ms >= headway_ms) {
+        a->credito_ms -= headway_ms;
+        if (a->fila > 0) {
+            a->fila--;
+            r->partidas++;
+        }
+    }
+}
+
+static void simular(uint32_t tarefa) {
+    uint32_t plano_idx = (tarefa / reps) % NUM_PLANOS;
+    const cenario_t *c = &cenarios[tarefa / reps / NUM_PLANOS];
+
+    etapa_t etapas[3] = {
+        {PHASE_VERDE, (uint16_t)((VARREDURA_MIN_S + plano_idx / VARREDURA_N) * 1000 / TICK_MS), true},
+        {PHASE_AMARELO, AMARELO_S * 1000 / TICK_MS, false},
+        {PHASE_VERMELHO, (uint16_t)((VARREDURA_MIN_S + plano_idx % VARREDURA_N) * 1000 / TICK_MS), true},
+    };
+    plano_t plano = {etapas, 3};
+    semaforo_t s;
+    semaforo_start(&s, MODE_NORMAL, &plano);
+
+    uint64_t rng = semente ^ ((uint64_t)tarefa << 32);
+    uint32_t p_principal = prob_tick(c->principal_veh_h);
+    uint32_t p_transversal = prob_tick(c->transversal_veh_h);
+    aproximacao_t principal = {0}, transversal = {0};
+    resultado_t r = {0};
+
+    for (uint32_t t = 0; t < SIM_TICKS; t++) {
+        uint64_t sorteio = splitmix64(&rng);
+        if ((uint32_t)sorteio < p_principal) { principal.fila++; r.chegadas++; }
+        if ((uint32_t)(sorteio >> 32) < p_transversal) { transversal.fila++; r.chegadas++; }
+
+        aproximacao_tick(&principal, s.phase == PHASE_VERDE, &r);
+        aproximacao_tick(&transversal, s.phase == PHASE_VERMELHO, &r);
+
+        uint32_t fila = principal.fila + transversal.fila;
+        r.fila_ticks += fila;
+        if (fila > r.fila_max) r.fila_max = fila;
+        semaforo_step(&s, MODE_NORMAL);
+    }
+    resultados[tarefa] = r;
+}
+
+// Pool com roubo de trabalho: cada thread começa com uma faixa contígua de
+// tarefas e consome pela frente; quem esvazia rouba a metade final da faixa
+// de outra thread.
+typedef struct {
+    pthread_mutex_t lock;
+    uint32_t inicio;
+    uint32_t fim;
+    uint32_t roubos;
+} faixa_t;
+
+static faixa_t *faixas;
+static uint32_t num_threads;
+
+static bool pegar(faixa_t *f, uint32_t *tarefa) {
+    pthread_mutex_lock(&f->lock);
+    bool ok = f->inicio < f->fim;
+    if (ok) *tarefa = f->inicio++;
+    pthread_mutex_unlock(&f->lock);
+    return ok;
+}
+
+static bool roubar(uint32_t ladrao) {
+    faixa_t *minha = &faixas[ladrao];
+    for (uint32_t i = 1; i < num_threads; i++) {
+        faixa_t *v = &faixas[(ladrao + i) % num_threads];
+        pthread_mutex_lock(&v->lock);
+        uint32_t resto = v->fim - v->inicio;
+        if (resto >= 2) {
+            uint32_t meio = v->fim - resto / 2;
+            pthread_mutex_lock(&minha->lock);
+            minha->inicio = meio;
+            minha->fim = v->fim;
+            minha->roubos++;
+            pthread_mutex_unlock(&minha->lock);
+            v->fim = meio;
+            pthread_mutex_unlock(&v->lock);
+            return true;
+        }
+        pthread_mutex_unlock(&v->lock);
+    }
+    return false;
+}
+
+static void *trabalhador(void *arg) {
+    uint32_t id = (uint32_t)(uintptr_t)arg;
+    uint32_t tarefa;
+    do {
+        while (pegar(&faixas[id], &tarefa)) {
+            simular(tarefa);
+        }
+    } while (roubar(id));
+    return NULL;
+}
+
+typedef struct {
+    double veh_h;
+    double atraso_s;   // Atraso médio por veículo atendido
+    double fila_media;
+    double fila_max;
+} metricas_t;
+
+// Média das réplicas de um plano em um cenário
+static metricas_t metricas(uint32_t cenario, uint32_t plano_idx) {
+    metricas_t m = {0};
+    const resultado_t *r = &resultados[((size_t)cenario * NUM_PLANOS + plano_idx) * reps];
+    for (uint32_t i = 0; i < reps; i++) {
+        m.veh_h += (double)r[i].partidas / SIM_HORAS;
+        m.atraso_s += r[i].partidas ? r[i].fila_ticks * (TICK_MS / 1000.0) / r[i].partidas : 0;
+        m.fila_media += (double)r[i].fila_ticks / SIM_TICKS;
+        m.fila_max += r[i].fila_max;
+    }
+    m.veh_h /= reps;
+    m.atraso_s /= reps;
+    m.fila_media /= reps;
+    m.fila_max /= reps;
+    return m;
+}
+
+static void imprimir(uint32_t cenario, const char *nome, uint32_t plano_idx) {
+    metricas_t m = metricas(cenario, plano_idx);
+    printf("{\"cenario\":\"%s\",\"plano\":\"%s\",\"verde_s\":%u,\"amarelo_s\":%u,\"vermelho_s\":%u,"
+           "\"veh_h\":%.1f,\"atraso_s\":%.2f,\"fila_media\":%.2f,\"fila_max\":%.1f}\n",
+           cenarios[cenario].nome, nome, VARREDURA_MIN_S + plano_idx / VARREDURA_N, AMARELO_S,
+           VARREDURA_MIN_S + plano_idx % VARREDURA_N, m.veh_h, m.atraso_s, m.fila_media, m.fila_max);
+}
+
+// Bipes do buzzer_pt do firmware (conjunto chirp): duração do som e período, por fase
+typedef struct {
+    uint16_t som_ms;
+    uint16_t periodo_ms;
+} bipe_t;
+
+static bipe_t bipe(uint8_t mode, uint8_t phase) {
+    switch (phase) {
+        case PHASE_VERDE:
+            return (bipe_t){150, 1000};
+        case PHASE_AMARELO:
+            return (bipe_t){200, 428};
+        case PHASE_VERMELHO:
+            return (bipe_t){500, mode == MODE_ALTO_FLUXO ? 2143 : mode == MODE_BAIXO_FLUXO ? 2083 : 2000};
+        default:
+            return (bipe_t){200, 2000}; // Noturno: localizador
+    }
+}
+
+static void energia_simular(uint8_t mode, energia_modo_t *m) {
+    static ssd1306_t ssd;
+    ssd1306_init(&ssd, 128, 64, false, 0x3C, NULL);
+    ssd1306_config(&ssd);
+
+    semaforo_t s;
+    semaforo_start(&s, mode, semaforo_plano(mode));
+    uint32_t frame[NUM_LEDS];
+    uint32_t last_key = UINT32_MAX;
+    double buzzer_ms = 0;
+    for (uint32_t t = 0; t < SIM_TICKS; t++) {
+        // Mesma ordem da vMatrixLedTask: o quadro do estado atual fica aceso um tick
+        matriz_compose_frame(frame, s.phase, s.time_remaining_ms);
+        m->matriz_contagem_ms += (uint64_t)energia_soma_quadro(frame) * TICK_MS;
+
+        bool r = s.phase != PHASE_VERDE && s.phase != PHASE_PISCANTE_APAGADO;
+        bool g = s.phase == PHASE_VERDE || s.phase == PHASE_AMARELO || s.phase == PHASE_PISCANTE_ACESO;
+        m->rgb_ms[0] += r ? TICK_MS : 0;
+        m->rgb_ms[1] += g ? TICK_MS : 0;
+
+        bipe_t b = bipe(mode, s.phase);
+        buzzer_ms += (double)TICK_MS * b.som_ms / b.periodo_ms;
+
+        // Governador do display: um quadro por mudança da chave (o tick é maior que PAINEL_MIN_FRAME_MS)
+        uint32_t key = painel_state_key(mode, s.phase, s.time_remaining_ms);
+        if (key != last_key) {
+            painel_render(&ssd, mode, s.phase, s.time_remaining_ms);
+            ssd1306_send_data(&ssd);
+            last_key = key;
+        }
+
+        m->tempo_ms += TICK_MS;
+        semaforo_step(&s, mode);
+    }
+    m->buzzer_ms = (uint32_t)buzzer_ms;
+    m->i2c_bytes = ssd.bytes_sent;
+}
+
+static int energia_main(void) {
+    for (uint8_t mode = 0; mode < NUM_MODES; mode++) {
+        energia_modo_t m = {0};
+        energia_consumo_t c;
+        energia_simular(mode, &m);
+        energia_consumo(&m, &c);
+        printf("{\"sim\":\"energia\",\"modo\":\"%s\",\"mAh_h\":%.1f,\"base_uA\":%u,\"matriz_uA\":%u,"
+               "\"rgb_uA\":%u,\"buzzer_uA\":%u,\"i2c_uA\":%u,\"oled_uA\":%u,\"matriz_permil\":%u,"
+               "\"buzzer_permil\":%u,\"i2c_B_s\":%.1f}\n",
+               energia_nome_modo(mode), c.total_ua / 1000.0, c.base_ua, c.matriz_ua, c.rgb_ua, c.buzzer_ua,
+               c.i2c_ua, c.oled_ua,
+               energia_permil(m.matriz_contagem_ms, (uint64_t)m.tempo_ms * NUM_LEDS * 3 * 255),
+               energia_permil(m.buzzer_ms, m.tempo_ms), m.i2c_bytes * 1000.0 / m.tempo_ms);
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "--energia") == 0) {
+        return energia_main();
+    }
+    num_threads = (uint32_t)sysconf(_SC_NPROCESSORS_ONLN);
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--seed") == 0) semente = strtoull(argv[i + 1], NULL, 0);
+        else if (strcmp(argv[i], "--threads") == 0) num_threads = (uint32_t)atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--reps") == 0) reps = (uint32_t)atoi(argv[i + 1]);
+    }
+    if (num_threads == 0) num_threads = 1;
+    if (reps == 0) reps = 1;
+
+    num_tarefas = NUM_CENARIOS * NUM_PLANOS * reps;
+    resultados = calloc(num_tarefas, sizeof(resultado_t));
+    faixas = calloc(num_threads, sizeof(faixa_t));
+    pthread_t *threads = calloc(num_threads, sizeof(pthread_t));
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (uint32_t i = 0; i < num_threads; i++) {
+        pthread_mutex_init(&faixas[i].lock, NULL);
+        faixas[i].inicio = (uint32_t)((uint64_t)num_tarefas * i / num_threads);
+        faixas[i].fim = (uint32_t)((uint64_t)num_tarefas * (i + 1) / num_threads);
+    }
+    for (uint32_t i = 0; i < num_threads; i++) {
+        pthread_create(&threads[i], NULL, trabalhador, (void *)(uintptr_t)i);
+    }
+    uint32_t roubos = 0;
+    for (uint32_t i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+        roubos += faixas[i].roubos;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    for (uint32_t c = 0; c < NUM_CENARIOS; c++) {
+        for (size_t p = 0; p < sizeof(planos_firmware) / sizeof(planos_firmware[0]); p++) {
+            const plano_nomeado_t *pn = &planos_firmware[p];
+            imprimir(c, pn->nome, (pn->verde_s - VARREDURA_MIN_S) * VARREDURA_N + (pn->vermelho_s - VARREDURA_MIN_S));
+        }
+        // Menores atrasos médios da varredura (inserção ordenada)
+        uint32_t melhores[MELHORES];
+        double atrasos[MELHORES];
+        uint32_t n = 0;
+        for (uint32_t p = 0; p < NUM_PLANOS; p++) {
+            double a = metricas(c, p).atraso_s;
+            if (n == MELHORES && a >= atrasos[n - 1]) continue;
+            uint32_t k = n < MELHORES ? n++ : MELHORES - 1;
+            for (; k > 0 && atrasos[k - 1] > a; k--) {
+                atrasos[k] = atrasos[k - 1];
+                melhores[k] = melhores[k - 1];
+            }
+            atrasos[k] = a;
+            melhores[k] = p;
+        }
+        for (uint32_t k = 0; k < n; k++) {
+            imprimir(c, "varredura", melhores[k]);
+        }
+    }
+
+    // Resumo: digest dos resultados brutos (igual para qualquer número de threads)
+    uint64_t digest = 0xCBF29CE484222325ull;
+    for (uint32_t i = 0; i < num_tarefas; i++) {
+        const resultado_t *r = &resultados[i];
+        uint64_t campos[4] = {r->chegadas, r->partidas, r->fila_ticks, r->fila_max};
+        for (int k = 0; k < 4; k++) {
+            digest = (digest ^ campos[k]) * 0x100000001B3ull;
+        }
+    }
+    double ms = (t1.tv_sec - t0.tv_sec) * 1e3 + (t1.tv_nsec - t0.tv_nsec) / 1e6;
+    printf("{\"target\":\"host\",\"sim\":\"resumo\",\"seed\":%llu,\"tarefas\":%u,\"threads\":%u,\"roubos\":%u,"
+           "\"ms\":%.0f,\"tarefas_por_s\":%.0f,\"digest\":\"%016llx\"}\n",
+           (unsigned long long)semente, num_tarefas, num_threads, roubos, ms, num_tarefas / (ms / 1e3),
+           (unsigned long long)digest);
+    return 0;
+}
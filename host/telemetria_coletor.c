@@ -0,0 +1,305 @@
+// Coletor de telemetria UDP.
+//
+//   telemetria_coletor [porta]    escuta os armários e imprime cada datagrama em JSON,
+//                                 com os lotes perdidos no enlace e os não enviados
+//                                 pela placa; avisa quando um armário fica em silêncio
+//   telemetria_coletor --loopback teste local: o escalonador de fases roda em tempo
+//                                 simulado, os lotes saem por um socket UDP em
+//                                 127.0.0.1 e são conferidos na chegada
+//
+// O teste local confere sequência, eventos (nenhum perdido ou alterado), a
+// cadência e o limite de taxa, inclusive numa rajada que enche os lotes. Parte
+// dos lotes é recusada pelo "transporte" e parte some no caminho: a contagem de
+// cada tipo de perda tem de bater com a injetada.
+// Retorna 1 se alguma verificação falhar.
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include "semaforo.h"
+#include "telemetria.h"
+
+#define PORTA_PADRAO 5005
+#define LOOPBACK_MINUTOS 10
+#define RAJADA_EVENTOS 16
+#define MAX_ARMARIOS 32
+#define SILENCIO_MS (3 * TELEMETRIA_PERIODO_MS) // Sem lote por três cadências: armário parado
+
+typedef telemetria_registro_t registro_t;
+
+// Saúde do enlace de um armário, a partir da sequência e do contador de erros
+typedef struct {
+    bool visto;
+    bool calado; // Silêncio já avisado
+    uint16_t id;
+    uint16_t falhas_envio;
+    uint32_t seq;
+    uint64_t chegada_ms;
+    uint32_t perdidos_enlace;
+    uint32_t nao_enviados;
+    uint32_t reinicios;
+} saude_t;
+
+// Lotes que faltaram antes deste, separados pela causa. Sequência menor que a
+// anterior é um reboot da placa: a contagem recomeça.
+static void saude_atualizar(saude_t *s, const telemetria_cabecalho_t *c, uint32_t *enlace, uint32_t *envio) {
+    *enlace = 0;
+    *envio = 0;
+    if (s->visto && c->seq > s->seq) {
+        uint32_t faltam = c->seq - s->seq - 1;
+        uint32_t falhas = (uint16_t)(c->falhas_envio - s->falhas_envio);
+        *envio = falhas < faltam ? falhas : faltam;
+        *enlace = faltam - *envio;
+    } else if (s->visto) {
+        s->reinicios++;
+    }
+    s->perdidos_enlace += *enlace;
+    s->nao_enviados += *envio;
+    s->visto = true;
+    s->calado = false;
+    s->id = c->id;
+    s->seq = c->seq;
+    s->falhas_envio = c->falhas_envio;
+}
+
+static saude_t armarios[MAX_ARMARIOS];
+
+static saude_t *armario(uint16_t id) {
+    for (int i = 0; i < MAX_ARMARIOS; i++) {
+        if (armarios[i].visto && armarios[i].id == id) return &armarios[i];
+    }
+    for (int i = 0; i < MAX_ARMARIOS; i++) {
+        if (!armarios[i].visto) return &armarios[i];
+    }
+    return NULL;
+}
+
+static uint64_t agora_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void imprimir(const uint8_t *dados, size_t len) {
+    telemetria_cabecalho_t c;
+    if (!telemetria_decode(dados, len, &c)) {
+        printf("{\"erro\":\"datagrama invalido\",\"bytes\":%zu}\n", len);
+        return;
+    }
+    uint32_t enlace = 0, envio = 0;
+    saude_t *s = armario(c.id);
+    if (s != NULL) {
+        saude_atualizar(s, &c, &enlace, &envio);
+        s->chegada_ms = agora_ms();
+    }
+    printf("{\"id\":%u,\"seq\":%u,\"t_ms\":%u,\"mode\":%u,\"phase\":%u,\"descartados\":%u,\"falhas_envio\":%u,"
+           "\"perdidos_enlace\":%u,\"nao_enviados\":%u,\"eventos\":[",
+           c.id, c.seq, c.t_ms, c.mode, c.phase, c.descartados, c.falhas_envio, enlace, envio);
+    for (uint8_t i = 0; i < c.num_eventos; i++) {
+        telemetria_registro_t r;
+        telemetria_decode_evento(dados, i, &r);
+        printf("%s[%u,%u,%u]", i ? "," : "", r.t_ms, r.mode, r.phase);
+    }
+    printf("]}\n");
+    fflush(stdout);
+}
+
+// Armários que passaram de SILENCIO_MS sem lote: a placa parou de enviar (ou o
+// enlace caiu de vez); um aviso por silêncio
+static void conferir_silencio(void) {
+    uint64_t agora = agora_ms();
+    for (int i = 0; i < MAX_ARMARIOS; i++) {
+        saude_t *s = &armarios[i];
+        if (s->visto && !s->calado && agora - s->chegada_ms >= SILENCIO_MS) {
+            s->calado = true;
+            printf("{\"id\":%u,\"silencio_ms\":%llu,\"ultima_seq\":%u,\"perdidos_enlace\":%u,\"nao_enviados\":%u}\n",
+                   s->id, (unsigned long long)(agora - s->chegada_ms), s->seq, s->perdidos_enlace, s->nao_enviados);
+            fflush(stdout);
+        }
+    }
+}
+
+static int escutar(uint16_t porta) {
+    int s = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = htons(porta), .sin_addr.s_addr = htonl(INADDR_ANY) };
+    if (s < 0 || bind(s, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        perror("bind");
+        return 1;
+    }
+    struct timeval timeout = { .tv_sec = 1 }; // Acorda sem lotes para conferir o silêncio
+    setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    uint8_t buf[1500];
+    while (true) {
+        ssize_t n = recv(s, buf, sizeof(buf), 0);
+        if (n > 0) imprimir(buf, (size_t)n);
+        conferir_silencio();
+    }
+}
+
+// Estado do teste local
+static int tx, rx;
+static struct sockaddr_in destino;
+static telemetria_t telemetria;
+static uint32_t falhas, datagramas, eventos_rx, bytes_rx;
+static uint32_t seq_esperada;
+static uint32_t ultimo_t_ms;
+static saude_t saude;
+// Perdas injetadas: o transporte recusa um lote a cada RECUSA_A_CADA e o
+// "enlace" perde outro a cada PERDA_A_CADA (contados nos lotes fechados)
+#define RECUSA_A_CADA 37
+#define PERDA_A_CADA 53
+static uint32_t recusados, perdidos, enlace_rx, envio_rx;
+
+#define FALHA(...) do { fprintf(stderr, __VA_ARGS__); fputc('\n', stderr); falhas++; } while (0)
+
+// Envia o lote direto do buffer da telemetria e confere o que chegou. Um lote
+// recusado ou perdido leva os eventos junto; o próximo que chegar conta a lacuna.
+static void enviar_e_conferir(const uint8_t *dados, size_t len, const registro_t *esperados,
+                              uint32_t *num_esperados, uint32_t *eventos_perdidos) {
+    uint32_t lote = telemetria.enviados; // Lotes fechados até aqui, este incluído
+    if (lote % RECUSA_A_CADA == 0 || lote % PERDA_A_CADA == 0) {
+        if (lote % RECUSA_A_CADA == 0) {
+            telemetria_falha_envio(&telemetria);
+            recusados++;
+        } else {
+            perdidos++;
+        }
+        *eventos_perdidos += *num_esperados;
+        *num_esperados = 0;
+        seq_esperada++;
+        return;
+    }
+    sendto(tx, dados, len, 0, (struct sockaddr *)&destino, sizeof(destino));
+
+    uint8_t buf[1500];
+    ssize_t n = recv(rx, buf, sizeof(buf), 0);
+    telemetria_cabecalho_t c;
+    if (n <= 0 || !telemetria_decode(buf, (size_t)n, &c)) {
+        FALHA("datagrama %u invalido", datagramas);
+        return;
+    }
+    datagramas++;
+    bytes_rx += (uint32_t)n;
+    if (c.seq != seq_esperada) FALHA("seq %u, esperada %u", c.seq, seq_esperada);
+    seq_esperada = c.seq + 1;
+    uint32_t enlace, envio;
+    saude_atualizar(&saude, &c, &enlace, &envio);
+    enlace_rx += enlace;
+    envio_rx += envio;
+    if (datagramas > 1 && enlace + envio == 0) { // Depois de uma lacuna o intervalo não diz nada
+        uint32_t intervalo = c.t_ms - ultimo_t_ms;
+        if (intervalo < TELEMETRIA_MIN_INTERVALO_MS) FALHA("intervalo de %u ms abaixo do limite", intervalo);
+        if (c.num_eventos < TELEMETRIA_MAX_EVENTOS && intervalo < TELEMETRIA_PERIODO_MS) {
+            FALHA("lote incompleto enviado antes da cadência (%u ms)", intervalo);
+        }
+    }
+    ultimo_t_ms = c.t_ms;
+
+    uint32_t recebidos = c.num_eventos < *num_esperados ? c.num_eventos : *num_esperados;
+    if (c.num_eventos != *num_esperados) FALHA("%u eventos, esperados %u", c.num_eventos, *num_esperados);
+    for (uint8_t i = 0; i < recebidos; i++) {
+        telemetria_registro_t r;
+        telemetria_decode_evento(buf, i, &r);
+        // Campo a campo: os bytes de preenchimento do registro não têm valor definido
+        const registro_t *e = &esperados[i];
+        if (r.t_ms != e->t_ms || r.mode != e->mode || r.phase != e->phase) {
+            FALHA("evento %u do datagrama %u difere", i, c.seq);
+        }
+    }
+    eventos_rx += c.num_eventos;
+    *num_esperados = 0;
+}
+
+static int loopback(void) {
+    tx = socket(AF_INET, SOCK_DGRAM, 0);
+    rx = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = 0, .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+    socklen_t addr_len = sizeof(addr);
+    if (tx < 0 || rx < 0 || bind(rx, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        getsockname(rx, (struct sockaddr *)&destino, &addr_len) < 0) {
+        perror("socket");
+        return 1;
+    }
+    struct timeval timeout = { .tv_sec = 1 };
+    setsockopt(rx, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    telemetria_init(&telemetria, 1, 0);
+    semaforo_t semaforo;
+    semaforo_start(&semaforo, MODE_NORMAL, semaforo_plano(MODE_NORMAL));
+
+    // Eventos registrados desde o último lote, para conferir a chegada
+    registro_t esperados[TELEMETRIA_MAX_EVENTOS];
+    uint32_t num_esperados = 0, eventos_tx = 0, descartados = 0, eventos_perdidos = 0;
+    uint32_t total_ticks = LOOPBACK_MINUTOS * 60000 / TICK_MS;
+
+    for (uint32_t tick = 1; tick <= total_ticks; tick++) {
+        uint32_t agora = tick * TICK_MS;
+        // 1º minuto: rajada de RAJADA_EVENTOS por tick (entrada oscilando), que enche os
+        // lotes antes da cadência e força o limite de taxa e os descartes. Depois, o
+        // escalonador real, trocando de modo a cada 2 minutos.
+        uint32_t num_eventos = 0;
+        registro_t novos[RAJADA_EVENTOS];
+        if (tick < 600) {
+            for (uint32_t k = 0; k < RAJADA_EVENTOS; k++) {
+                novos[num_eventos++] = (registro_t){ agora, k % NUM_MODES, k % 5 };
+            }
+        } else {
+            uint8_t mode = (tick / 1200) % NUM_MODES;
+            uint8_t last_mode = semaforo.mode;
+            if (semaforo_step(&semaforo, mode) || semaforo.mode != last_mode) {
+                novos[num_eventos++] = (registro_t){ agora, semaforo.mode, semaforo.phase };
+            }
+        }
+
+        for (uint32_t k = 0; k < num_eventos; k++) {
+            if (telemetria_evento(&telemetria, agora, novos[k].mode, novos[k].phase)) {
+                esperados[num_esperados++] = novos[k];
+                eventos_tx++;
+            } else {
+                descartados++;
+            }
+        }
+        const uint8_t *dados;
+        size_t len = telemetria_fechar(&telemetria, agora, &dados);
+        if (len > 0) {
+            enviar_e_conferir(dados, len, esperados, &num_esperados, &eventos_perdidos);
+        }
+    }
+
+    if (eventos_rx + eventos_perdidos + num_esperados != eventos_tx) {
+        FALHA("%u eventos enviados, %u recebidos e %u em lotes perdidos", eventos_tx, eventos_rx, eventos_perdidos);
+    }
+    // Lotes do fim sem um seguinte que conte a lacuna não entram na conferência
+    uint32_t ultimo = telemetria.enviados;
+    while (ultimo > 0 && (ultimo % RECUSA_A_CADA == 0 || ultimo % PERDA_A_CADA == 0)) {
+        if (ultimo % RECUSA_A_CADA == 0) recusados--;
+        else perdidos--;
+        ultimo--;
+    }
+    if (envio_rx != recusados) FALHA("%u lotes nao enviados contados, %u recusados", envio_rx, recusados);
+    if (enlace_rx != perdidos) FALHA("%u lotes perdidos no enlace contados, %u perdidos", enlace_rx, perdidos);
+    if (perdidos == 0 || recusados == 0) FALHA("nenhuma perda injetada");
+    if (telemetria.descartados != descartados) FALHA("contador de descartes %u, esperado %u",
+                                                    telemetria.descartados, descartados);
+
+    double segundos = total_ticks * TICK_MS / 1000.0;
+    printf("{\"target\":\"host\",\"test\":\"telemetria_loopback\",\"segundos\":%.0f,\"datagramas\":%u,"
+           "\"eventos\":%u,\"descartados\":%u,\"nao_enviados\":%u,\"perdidos_enlace\":%u,"
+           "\"bytes_por_datagrama\":%.1f,\"datagramas_por_s\":%.2f,\"falhas\":%u}\n",
+           segundos, datagramas, eventos_rx, descartados, envio_rx, enlace_rx,
+           datagramas ? (double)bytes_rx / datagramas : 0.0, datagramas / segundos, falhas);
+    close(tx);
+    close(rx);
+    return falhas ? 1 : 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "--loopback") == 0) {
+        return loopback();
+    }
+    return escutar(argc > 1 ? (uint16_t)atoi(argv[1]) : PORTA_PADRAO);
+}
@@ -75,12 +75,19 @@
  #define configAPPLICATION_ALLOCATED_HEAP        0
  
  /* Hook function related definitions. */
- #define configCHECK_FOR_STACK_OVERFLOW          0
- #define configUSE_MALLOC_FAILED_HOOK            0
+ /* Ganchos em lib/caixa_preta.c: registram a falha e reiniciam pelo watchdog */
+ #define configCHECK_FOR_STACK_OVERFLOW          2
+ #define configUSE_MALLOC_FAILED_HOOK            1
  #define configUSE_DAEMON_TASK_STARTUP_HOOK      0
  
  /* Run time and task stats gathering related definitions. */
- #define configGENERATE_RUN_TIME_STATS           0
+ /* Tempo de execução em µs pelo timer do RP2040: CPU ativa x ociosa na contabilidade de energia */
+ #define configGENERATE_RUN_TIME_STATS           1
+ #ifndef __ASSEMBLER__
+ #include "hardware/timer.h"
+ #endif
+ #define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+ #define portGET_RUN_TIME_COUNTER_VALUE()        time_us_32()
  #define configUSE_TRACE_FACILITY                1
  #define configUSE_STATS_FORMATTING_FUNCTIONS    0
  
@@ -110,9 +117,13 @@
  #define configSUPPORT_PICO_SYNC_INTEROP         1
  #define configSUPPORT_PICO_TIME_INTEROP         1
  
- #include <assert.h>
- /* Define to trap errors during development. */
- #define configASSERT(x)                         assert(x)
+ /* Asserts também vão para a caixa preta (arquivo e linha), em vez de parar a placa */
+ #if defined(__cplusplus)
+ extern "C" void caixa_preta_assert(const char *arquivo, int linha); /* configASSERT em intersecao.cpp */
+ #elif !defined(__ASSEMBLER__)
+ extern void caixa_preta_assert(const char *arquivo, int linha);
+ #endif
+ #define configASSERT(x)                         do { if (!(x)) caixa_preta_assert(__FILE__, __LINE__); } while (0)
  
  /* Set the following definitions to 1 to include the API function, or zero
  to exclude the API function. */
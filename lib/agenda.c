@@ -0,0 +1,54 @@
+#include "agenda.h"
+#include <stddef.h>
+
+void agenda_init(agenda_t *a, uint32_t agora_ms) {
+    roda_init(&a->roda, agora_ms);
+    a->num_pts = 0;
+    a->passadas = 0;
+}
+
+void agenda_add(agenda_t *a, agenda_pt_t *p, agenda_fn_t fn, uint32_t mascara, const char *nome) {
+    if (a->num_pts >= AGENDA_MAX) {
+        return;
+    }
+    PT_INIT(&p->pt);
+    p->timer.ativo = false;
+    p->fn = fn;
+    p->agenda = a;
+    p->nome = nome;
+    p->mascara = mascara;
+    p->eventos = 0;
+    p->dormindo = false; // Executa na primeira passada
+    a->pts[a->num_pts++] = p;
+}
+
+void agenda_dormir(agenda_pt_t *p, uint32_t ms) {
+    p->eventos = 0;
+    p->dormindo = true;
+    roda_agendar(&p->agenda->roda, &p->timer, p->agenda->roda.agora_ms + ms);
+}
+
+static void acordar(roda_timer_t *t, void *arg) {
+    (void)arg;
+    ((agenda_pt_t *)t)->dormindo = false;
+}
+
+uint32_t agenda_executar(agenda_t *a, uint32_t agora_ms, uint32_t eventos) {
+    roda_avancar(&a->roda, agora_ms, acordar, NULL);
+
+    bool cedeu = false;
+    for (uint8_t i = 0; i < a->num_pts; i++) {
+        agenda_pt_t *p = a->pts[i];
+        uint32_t meus = eventos & p->mascara;
+        if (p->dormindo && meus) {
+            roda_cancelar(&a->roda, &p->timer);
+            p->eventos = meus;
+            p->dormindo = false;
+        }
+        if (!p->dormindo) {
+            a->passadas++;
+            cedeu |= p->fn(p) != PT_ESPERANDO; // Cedeu (ou terminou e recomeça): roda de novo logo
+        }
+    }
+    return cedeu ? 0 : roda_proximo_ms(&a->roda);
+}
@@ -0,0 +1,53 @@
+#ifndef AGENDA_H
+#define AGENDA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "pt.h"
+#include "roda.h"
+
+// Escalonador cooperativo de protothreads com roda de temporizadores comum.
+// Roda dentro de uma única tarefa: cada sequenciador de saída dorme por um
+// prazo e/ou até um evento (bits entregues por agenda_executar).
+
+#define AGENDA_MAX 8
+
+typedef struct agenda agenda_t;
+typedef struct agenda_pt agenda_pt_t;
+typedef int (*agenda_fn_t)(agenda_pt_t *p);
+
+struct agenda_pt {
+    roda_timer_t timer; // Primeiro membro: o disparo da roda chega à protothread
+    pt_t pt;
+    agenda_fn_t fn;
+    agenda_t *agenda;
+    const char *nome;
+    uint32_t mascara; // Eventos que acordam esta protothread
+    uint32_t eventos; // Eventos que a acordaram (0 = prazo vencido)
+    bool dormindo;
+};
+
+struct agenda {
+    roda_t roda;
+    agenda_pt_t *pts[AGENDA_MAX];
+    uint8_t num_pts;
+    uint32_t passadas; // Execuções de protothreads, para diagnóstico
+};
+
+void agenda_init(agenda_t *a, uint32_t agora_ms);
+void agenda_add(agenda_t *a, agenda_pt_t *p, agenda_fn_t fn, uint32_t mascara, const char *nome);
+// Entrega os eventos, dispara os prazos vencidos e executa as protothreads
+// acordadas. Retorna quantos ms a tarefa pode dormir (RODA_SEM_PRAZO = até um evento).
+uint32_t agenda_executar(agenda_t *a, uint32_t agora_ms, uint32_t eventos);
+
+// Arma o prazo da protothread; usado por AGENDA_ESPERAR
+void agenda_dormir(agenda_pt_t *p, uint32_t ms);
+
+// Dorme por ms ou até um evento da máscara; depois, p->eventos diz qual dos dois
+#define AGENDA_ESPERAR(p, ms)                             \
+    do {                                                  \
+        agenda_dormir((p), (ms));                         \
+        PT_WAIT_UNTIL(&(p)->pt, !(p)->dormindo);          \
+    } while (0)
+
+#endif
@@ -0,0 +1,171 @@
+#include "audio.h"
+#include "audio_samples.h"
+#include "semaforo.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/pwm.h"
+#include "hardware/sync.h"
+
+// Portadora do PWM: 125 MHz / 4 / (TOP + 1) = 122 kHz no volume alto, sempre inaudível
+#define AUDIO_PWM_CLKDIV 4.0f
+
+// Verde, conjunto "chirp": varredura descendente curta (PCM)
+static const audio_nota_t notas_chirp[] = {
+    {audio_chirp, AUDIO_CHIRP_LEN, false, AUDIO_CHIRP_RATE, AUDIO_CHIRP_MS},
+};
+
+// Verde, conjunto "cuco": 1100 Hz seguido de 900 Hz
+static const audio_nota_t notas_cuco[] = {
+    {audio_seno, AUDIO_SENO_LEN, true, 1100 * AUDIO_SENO_LEN, 80},
+    {audio_seno, AUDIO_SENO_LEN, true, 900 * AUDIO_SENO_LEN, 120},
+};
+
+// Amarelo: bipe de atenção de 200 ms em 1 kHz
+static const audio_nota_t notas_atencao[] = {
+    {audio_seno, AUDIO_SENO_LEN, true, 1000 * AUDIO_SENO_LEN, 200},
+};
+
+// Vermelho: tom contínuo curto de 500 ms em 660 Hz (pare)
+static const audio_nota_t notas_pare[] = {
+    {audio_seno, AUDIO_SENO_LEN, true, 660 * AUDIO_SENO_LEN, 500},
+};
+
+// Noturno: tom localizador de 200 ms em 880 Hz
+static const audio_nota_t notas_localizador[] = {
+    {audio_seno, AUDIO_SENO_LEN, true, 880 * AUDIO_SENO_LEN, 200},
+};
+
+#define SOM(n) { n, sizeof(n) / sizeof(n[0]) }
+
+static const audio_som_t som_chirp = SOM(notas_chirp);
+static const audio_som_t som_cuco = SOM(notas_cuco);
+static const audio_som_t som_atencao = SOM(notas_atencao);
+static const audio_som_t som_pare = SOM(notas_pare);
+static const audio_som_t som_localizador = SOM(notas_localizador);
+
+const audio_conjunto_t audio_conjunto_chirp = {{
+    [PHASE_VERDE] = &som_chirp,
+    [PHASE_AMARELO] = &som_atencao,
+    [PHASE_VERMELHO] = &som_pare,
+    [PHASE_PISCANTE_ACESO] = &som_localizador,
+    [PHASE_PISCANTE_APAGADO] = &som_localizador,
+}};
+
+const audio_conjunto_t audio_conjunto_cuco = {{
+    [PHASE_VERDE] = &som_cuco,
+    [PHASE_AMARELO] = &som_atencao,
+    [PHASE_VERMELHO] = &som_pare,
+    [PHASE_PISCANTE_ACESO] = &som_localizador,
+    [PHASE_PISCANTE_APAGADO] = &som_localizador,
+}};
+
+static uint audio_gpio[2];
+static uint audio_slice[2];
+static uint audio_dma[2];
+static uint audio_timer;
+
+// Som em reprodução; as notas avançam por alarme, não por amostra. O alarme é
+// reescrito pela própria callback (IRQ): a tarefa só mexe nele com as IRQs desligadas.
+static const audio_som_t *som_atual = NULL;
+static uint8_t nota_atual;
+static volatile alarm_id_t alarme = 0;
+
+void audio_init(uint gpio_a, uint gpio_b) {
+    audio_gpio[0] = gpio_a;
+    audio_gpio[1] = gpio_b;
+    audio_timer = dma_claim_unused_timer(true);
+
+    for (int i = 0; i < 2; i++) {
+        gpio_set_function(audio_gpio[i], GPIO_FUNC_PWM);
+        audio_slice[i] = pwm_gpio_to_slice_num(audio_gpio[i]);
+        pwm_set_clkdiv(audio_slice[i], AUDIO_PWM_CLKDIV);
+        pwm_set_wrap(audio_slice[i], AUDIO_VOLUME_ALTO);
+        pwm_set_gpio_level(audio_gpio[i], 0); // Silêncio
+        pwm_set_enabled(audio_slice[i], true);
+        audio_dma[i] = dma_claim_unused_channel(true);
+    }
+}
+
+// Ritmo do DMA: clk_sys * x / y = rate_hz, com o maior x que mantém y em 16 bits
+static void audio_set_rate(uint32_t rate_hz) {
+    uint32_t clk = clock_get_hz(clk_sys);
+    uint32_t x = (uint32_t)((uint64_t)rate_hz * 0xFFFF / clk);
+    if (x == 0) x = 1;
+    uint32_t y = (uint32_t)(((uint64_t)x * clk + rate_hz / 2) / rate_hz);
+    dma_timer_set_fraction(audio_timer, x, y);
+}
+
+static int64_t audio_next_nota(alarm_id_t id, void *user_data);
+
+static void audio_start_nota(const audio_nota_t *n) {
+    audio_set_rate(n->rate_hz);
+
+    for (int i = 0; i < 2; i++) {
+        dma_channel_config c = dma_channel_get_default_config(audio_dma[i]);
+        // Escrita de meia palavra no CC é replicada nos canais A e B da fatia
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+        channel_config_set_read_increment(&c, true);
+        channel_config_set_write_increment(&c, false);
+        channel_config_set_dreq(&c, dma_get_timer_dreq(audio_timer));
+        if (n->loop) {
+            // Anel de leitura do tamanho da tabela: o tom se repete sem CPU
+            channel_config_set_ring(&c, false, __builtin_ctz(n->num_samples * sizeof(uint16_t)));
+        }
+        dma_channel_configure(audio_dma[i], &c, &pwm_hw->slice[audio_slice[i]].cc, n->samples,
+                              n->loop ? 0xFFFFFFFFu : n->num_samples, false);
+    }
+    dma_start_channel_mask((1u << audio_dma[0]) | (1u << audio_dma[1])); // Os dois buzzers em fase
+
+    alarme = add_alarm_in_ms(n->duration_ms, audio_next_nota, NULL, true);
+}
+
+static void audio_silence(void) {
+    for (int i = 0; i < 2; i++) {
+        dma_channel_abort(audio_dma[i]);
+        pwm_set_gpio_level(audio_gpio[i], 0);
+    }
+}
+
+static int64_t audio_next_nota(alarm_id_t id, void *user_data) {
+    alarme = 0;
+    audio_silence();
+    if (som_atual != NULL && ++nota_atual < som_atual->num_notas) {
+        audio_start_nota(&som_atual->notas[nota_atual]);
+    } else {
+        som_atual = NULL;
+    }
+    return 0; // Não reagenda
+}
+
+void audio_play(const audio_som_t *som, audio_volume_t volume) {
+    // Sem IRQ entre o cancelamento e o novo alarme: um alarme do som anterior
+    // não sobra para calar este
+    uint32_t irq = save_and_disable_interrupts();
+    audio_stop();
+    for (int i = 0; i < 2; i++) {
+        pwm_set_wrap(audio_slice[i], volume);
+    }
+    som_atual = som;
+    nota_atual = 0;
+    audio_start_nota(&som->notas[0]);
+    restore_interrupts(irq);
+}
+
+void audio_stop(void) {
+    uint32_t irq = save_and_disable_interrupts();
+    if (alarme > 0) {
+        cancel_alarm(alarme); // Ainda pendente: com as IRQs desligadas, a callback não rodou
+        alarme = 0;
+    }
+    som_atual = NULL;
+    audio_silence();
+    restore_interrupts(irq);
+}
+
+uint32_t audio_duracao_ms(const audio_som_t *som) {
+    uint32_t ms = 0;
+    for (uint8_t i = 0; i < som->num_notas; i++) {
+        ms += som->notas[i].duration_ms;
+    }
+    return ms;
+}
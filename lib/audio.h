@@ -0,0 +1,41 @@
+#ifndef AUDIO_H
+#define AUDIO_H
+
+#include "pico/stdlib.h"
+
+// Volume pelo TOP do PWM: as amostras (0..254) ocupam uma fração menor do período
+typedef enum {
+    AUDIO_VOLUME_ALTO = 255,
+    AUDIO_VOLUME_MEDIO = 511,
+    AUDIO_VOLUME_BAIXO = 1023
+} audio_volume_t;
+
+// Trecho de som lido pelo DMA direto da flash
+typedef struct {
+    const uint16_t *samples;
+    uint16_t num_samples; // Potência de 2 quando loop = true
+    bool loop;            // true = repete a tabela (síntese de tom), false = PCM tocado uma vez
+    uint32_t rate_hz;     // Amostras por segundo
+    uint16_t duration_ms; // Duração até a próxima nota (ou silêncio)
+} audio_nota_t;
+
+typedef struct {
+    const audio_nota_t *notas;
+    uint8_t num_notas;
+} audio_som_t;
+
+// Sons de cada fase (índice = PHASE_*)
+typedef struct {
+    const audio_som_t *fase[5];
+} audio_conjunto_t;
+
+extern const audio_conjunto_t audio_conjunto_chirp; // Verde com chirp
+extern const audio_conjunto_t audio_conjunto_cuco;  // Verde com "cu-co"
+
+void audio_init(uint gpio_a, uint gpio_b);
+void audio_play(const audio_som_t *som, audio_volume_t volume);
+void audio_stop(void);
+// Duração total do som (soma das notas), sem interrupção
+uint32_t audio_duracao_ms(const audio_som_t *som);
+
+#endif
@@ -0,0 +1,174 @@
+// Gerado por tools/gen_audio.py. Não edite à mão.
+#ifndef AUDIO_SAMPLES_H
+#define AUDIO_SAMPLES_H
+
+#include <stdint.h>
+
+#define AUDIO_SENO_LEN 64
+#define AUDIO_CHIRP_LEN 2400
+#define AUDIO_CHIRP_RATE 16000
+#define AUDIO_CHIRP_MS 150
+
+// Um período de seno; alinhado ao próprio tamanho para o anel de leitura do DMA
+static const uint16_t audio_seno[64] __attribute__((aligned(128))) = {
+    127, 139, 152, 164, 176, 187, 198, 208, 217, 225, 233, 239, 244, 249, 252, 253,
+    254, 253, 252, 249, 244, 239, 233, 225, 217, 208, 198, 187, 176, 164, 152, 139,
+    127, 115, 102, 90, 78, 67, 56, 46, 37, 29, 21, 15, 10, 5, 2, 1,
+    0, 1, 2, 5, 10, 15, 21, 29, 37, 46, 56, 67, 78, 90, 102, 115,
+};
+
+// Chirp: 3200 Hz -> 1800 Hz em 150 ms
+static const uint16_t audio_chirp[2400] = {
+    127, 130, 123, 119, 127, 137, 134, 120, 115, 127, 141, 136, 118, 111, 126, 144,
+    138, 117, 108, 126, 146, 141, 116, 106, 125, 148, 143, 115, 103, 124, 150, 145,
+    115, 101, 122, 151, 147, 116, 99, 120, 152, 150, 117, 97, 118, 152, 152, 118,
+    95, 115, 152, 155, 120, 94, 112, 151, 158, 122, 93, 109, 150, 160, 125, 92,
+    106, 148, 163, 129, 92, 102, 146, 165, 133, 92, 98, 143, 167, 138, 94, 94,
+    139, 168, 143, 96, 90, 134, 169, 148, 99, 87, 128, 169, 154, 103, 84, 122,
+    167, 159, 108, 82, 116, 165, 164, 114, 80, 108, 162, 169, 121, 80, 101, 157,
+    173, 129, 82, 94, 150, 176, 137, 85, 87, 142, 178, 146, 89, 82, 134, 177,
+    155, 96, 77, 124, 175, 164, 104, 74, 113, 171, 171, 114, 73, 102, 164, 178,
+    125, 75, 92, 155, 182, 137, 79, 83, 144, 184, 150, 86, 75, 132, 182, 162,
+    96, 70, 118, 178, 172, 108, 68, 104, 170, 181, 122, 70, 91, 159, 186, 138,
+    75, 79, 145, 188, 153, 84, 70, 129, 185, 167, 97, 65, 112, 178, 180, 114,
+    64, 95, 167, 188, 132, 69, 80, 151, 192, 150, 79, 69, 133, 190, 167, 94,
+    62, 113, 182, 182, 112, 61, 93, 168, 191, 133, 67, 76, 150, 195, 154, 79,
+    64, 128, 191, 174, 97, 58, 105, 180, 188, 120, 60, 84, 162, 196, 144, 70,
+    67, 140, 196, 167, 87, 57, 114, 187, 185, 110, 56, 90, 170, 197, 137, 64,
+    69, 146, 200, 163, 81, 56, 119, 192, 185, 106, 53, 91, 174, 199, 135, 61,
+    69, 148, 202, 163, 80, 54, 118, 193, 187, 107, 51, 89, 173, 201, 138, 61,
+    65, 145, 203, 169, 83, 51, 112, 192, 193, 113, 51, 81, 168, 205, 147, 65,
+    58, 135, 203, 178, 92, 47, 100, 185, 200, 126, 53, 69, 156, 208, 162, 74,
+    50, 119, 198, 191, 107, 46, 83, 173, 208, 145, 61, 56, 137, 206, 181, 91,
+    44, 97, 186, 204, 130, 52, 64, 152, 210, 169, 78, 45, 110, 196, 200, 117,
+    46, 72, 164, 212, 159, 68, 47, 121, 203, 194, 106, 42, 79, 173, 212, 151,
+    61, 49, 129, 207, 190, 98, 40, 84, 179, 212, 145, 56, 51, 135, 210, 187,
+    93, 39, 88, 183, 213, 142, 53, 51, 138, 212, 186, 91, 38, 89, 185, 213,
+    141, 52, 50, 138, 213, 188, 92, 37, 87, 184, 215, 144, 53, 48, 135, 213,
+    191, 95, 36, 82, 181, 217, 149, 55, 44, 129, 212, 197, 101, 35, 75, 175,
+    219, 157, 60, 40, 120, 208, 203, 111, 37, 66, 166, 221, 169, 68, 35, 107,
+    202, 211, 124, 40, 55, 153, 221, 182, 80, 32, 92, 192, 218, 141, 47, 45,
+    136, 217, 196, 97, 31, 74, 177, 223, 160, 60, 35, 115, 208, 210, 118, 36,
+    57, 157, 224, 181, 78, 29, 91, 193, 221, 143, 47, 41, 132, 217, 202, 102,
+    30, 67, 171, 226, 170, 66, 30, 102, 202, 219, 132, 40, 45, 141, 222, 197,
+    94, 28, 72, 177, 227, 166, 61, 30, 106, 206, 218, 129, 38, 45, 143, 224,
+    197, 93, 26, 71, 177, 229, 168, 62, 28, 103, 205, 221, 134, 39, 41, 137,
+    223, 203, 100, 26, 63, 170, 230, 177, 69, 24, 92, 198, 226, 146, 45, 33,
+    124, 218, 213, 114, 29, 50, 155, 229, 192, 84, 23, 74, 183, 231, 166, 59,
+    25, 102, 206, 225, 138, 39, 35, 131, 222, 211, 109, 26, 52, 158, 231, 192,
+    83, 21, 73, 183, 233, 169, 60, 22, 98, 204, 228, 144, 41, 30, 123, 220,
+    218, 119, 28, 43, 148, 230, 203, 95, 21, 60, 171, 235, 184, 73, 19, 79,
+    191, 234, 164, 54, 21, 100, 207, 230, 143, 40, 28, 121, 220, 221, 122, 29,
+    38, 142, 230, 210, 103, 21, 51, 161, 235, 196, 85, 17, 65, 178, 237, 181,
+    68, 17, 80, 193, 237, 166, 54, 19, 96, 206, 234, 150, 43, 23, 111, 216,
+    229, 135, 33, 29, 126, 224, 222, 121, 26, 36, 140, 231, 215, 108, 21, 43,
+    152, 235, 207, 96, 17, 52, 164, 238, 198, 85, 15, 60, 174, 240, 190, 76,
+    14, 68, 183, 241, 182, 67, 13, 76, 190, 240, 175, 60, 14, 83, 197, 240,
+    168, 54, 14, 89, 202, 239, 162, 49, 15, 95, 207, 238, 157, 45, 16, 99,
+    210, 237, 153, 42, 17, 103, 213, 237, 150, 40, 18, 105, 215, 236, 148, 38,
+    18, 107, 216, 236, 146, 37, 18, 108, 217, 236, 146, 37, 18, 107, 217, 237,
+    147, 38, 17, 106, 216, 237, 149, 39, 16, 103, 214, 239, 152, 41, 15, 100,
+    212, 240, 156, 43, 13, 95, 209, 241, 161, 47, 12, 90, 205, 243, 167, 52,
+    10, 84, 200, 244, 174, 57, 9, 76, 193, 245, 182, 64, 8, 68, 186, 246,
+    190, 73, 8, 60, 177, 245, 199, 82, 9, 51, 167, 244, 208, 93, 11, 42,
+    155, 241, 217, 106, 15, 33, 142, 236, 225, 119, 21, 24, 127, 230, 233, 134,
+    28, 17, 112, 221, 240, 150, 38, 11, 95, 210, 245, 167, 51, 7, 78, 196,
+    248, 184, 66, 6, 62, 180, 247, 200, 83, 8, 46, 161, 244, 216, 103, 13,
+    31, 140, 237, 229, 125, 23, 19, 118, 225, 240, 148, 36, 10, 95, 210, 247,
+    171, 54, 5, 72, 190, 249, 193, 75, 6, 50, 167, 246, 214, 100, 12, 31,
+    141, 237, 231, 127, 23, 16, 113, 222, 243, 156, 41, 7, 84, 201, 249, 184,
+    65, 4, 57, 175, 248, 209, 94, 9, 34, 145, 239, 230, 125, 22, 16, 112,
+    222, 244, 158, 43, 5, 80, 198, 251, 190, 71, 4, 50, 166, 247, 218, 105,
+    13, 25, 131, 233, 238, 142, 32, 9, 94, 209, 250, 178, 60, 3, 59, 177,
+    250, 211, 96, 9, 30, 139, 237, 236, 136, 28, 10, 98, 213, 250, 176, 58,
+    2, 60, 178, 250, 211, 97, 9, 28, 136, 236, 238, 140, 31, 8, 92, 208,
+    251, 183, 65, 2, 52, 168, 248, 220, 108, 13, 20, 122, 229, 244, 155, 41,
+    3, 76, 194, 252, 199, 82, 5, 36, 148, 242, 233, 130, 25, 10, 98, 213,
+    251, 180, 62, 1, 52, 169, 249, 221, 111, 14, 18, 117, 225, 247, 163, 48,
+    2, 66, 184, 252, 210, 96, 9, 25, 131, 233, 243, 151, 38, 3, 76, 194,
+    253, 202, 86, 5, 31, 140, 238, 239, 143, 33, 4, 82, 199, 253, 198, 81,
+    4, 33, 144, 240, 238, 141, 31, 5, 84, 200, 253, 198, 81, 4, 33, 143,
+    239, 239, 143, 33, 4, 81, 197, 254, 201, 86, 5, 29, 137, 236, 242, 150,
+    38, 2, 73, 190, 253, 209, 95, 8, 23, 126, 230, 247, 161, 47, 1, 61,
+    178, 251, 219, 109, 14, 15, 110, 220, 251, 177, 61, 0, 47, 161, 246, 231,
+    129, 25, 7, 90, 204, 254, 197, 81, 4, 30, 138, 236, 243, 153, 41, 1,
+    66, 182, 252, 217, 107, 14, 15, 109, 219, 252, 181, 65, 1, 41, 153, 243,
+    237, 139, 32, 3, 77, 193, 254, 210, 97, 10, 19, 118, 224, 250, 175, 60,
+    0, 45, 157, 245, 235, 137, 30, 4, 78, 193, 254, 210, 99, 10, 18, 114,
+    222, 251, 179, 65, 1, 40, 150, 241, 239, 145, 37, 2, 69, 183, 252, 219,
+    111, 16, 11, 100, 211, 253, 194, 80, 4, 28, 132, 232, 247, 165, 53, 0,
+    50, 162, 246, 234, 136, 31, 3, 75, 189, 253, 215, 107, 15, 13, 102, 212,
+    253, 194, 81, 5, 27, 129, 229, 248, 170, 58, 1, 44, 154, 242, 239, 146,
+    39, 1, 64, 177, 250, 226, 123, 24, 6, 85, 196, 253, 210, 101, 13, 15,
+    105, 213, 253, 193, 82, 6, 25, 125, 226, 249, 176, 64, 2, 38, 144, 237,
+    244, 159, 50, 1, 51, 160, 244, 236, 143, 37, 2, 64, 175, 249, 227, 128,
+    27, 5, 77, 188, 252, 218, 114, 20, 9, 90, 199, 253, 209, 101, 14, 14,
+    101, 209, 253, 200, 91, 10, 19, 112, 216, 252, 191, 81, 7, 24, 121, 222,
+    250, 184, 74, 5, 29, 129, 227, 248, 177, 67, 3, 34, 136, 231, 247, 171,
+    62, 3, 38, 141, 233, 245, 167, 59, 2, 41, 145, 235, 244, 164, 56, 2,
+    43, 147, 236, 243, 162, 55, 2, 44, 148, 236, 242, 161, 54, 2, 44, 148,
+    236, 242, 162, 55, 3, 43, 147, 235, 243, 164, 57, 3, 42, 144, 234, 244,
+    167, 60, 4, 39, 140, 231, 245, 171, 64, 4, 36, 135, 228, 246, 176, 70,
+    6, 32, 128, 224, 248, 183, 76, 7, 27, 120, 218, 249, 190, 84, 10, 22,
+    111, 212, 250, 198, 94, 14, 17, 101, 204, 250, 206, 105, 19, 13, 90, 194,
+    249, 215, 117, 26, 9, 78, 182, 247, 224, 131, 35, 6, 65, 169, 243, 232,
+    145, 46, 5, 52, 154, 236, 239, 161, 59, 5, 40, 137, 227, 245, 177, 74,
+    9, 29, 119, 216, 248, 193, 91, 15, 19, 100, 201, 248, 209, 111, 24, 11,
+    81, 183, 246, 223, 132, 38, 7, 62, 163, 239, 235, 154, 54, 6, 44, 141,
+    227, 243, 176, 75, 10, 28, 116, 212, 247, 198, 98, 19, 16, 92, 192, 246,
+    217, 124, 34, 9, 67, 168, 239, 232, 151, 53, 7, 45, 140, 226, 242, 178,
+    78, 12, 27, 111, 207, 246, 203, 106, 24, 14, 82, 182, 243, 223, 137, 44,
+    8, 55, 152, 231, 238, 168, 70, 11, 33, 120, 212, 245, 197, 101, 23, 17,
+    87, 185, 243, 221, 135, 43, 9, 56, 152, 230, 238, 169, 72, 12, 32, 116,
+    208, 244, 201, 107, 27, 15, 80, 177, 240, 225, 144, 51, 10, 48, 140, 223,
+    240, 181, 85, 18, 25, 101, 195, 243, 212, 124, 38, 12, 64, 159, 232, 234,
+    164, 69, 14, 34, 117, 207, 243, 201, 109, 30, 16, 77, 171, 236, 228, 152,
+    60, 13, 42, 128, 214, 241, 192, 100, 26, 19, 85, 178, 237, 223, 145, 55,
+    13, 47, 134, 216, 239, 188, 96, 25, 21, 88, 180, 237, 221, 143, 54, 14,
+    48, 134, 216, 239, 188, 97, 26, 22, 86, 178, 236, 222, 146, 58, 15, 45,
+    130, 212, 239, 192, 103, 30, 20, 80, 171, 233, 225, 154, 65, 17, 40, 120,
+    204, 238, 200, 114, 37, 18, 70, 159, 227, 230, 167, 77, 21, 33, 106, 192,
+    237, 210, 130, 48, 17, 57, 142, 217, 234, 182, 95, 28, 25, 87, 175, 232,
+    221, 150, 64, 19, 42, 120, 202, 236, 200, 118, 41, 20, 67, 152, 221, 231,
+    174, 87, 26, 29, 94, 180, 232, 217, 145, 62, 20, 46, 123, 203, 234, 198,
+    117, 42, 21, 67, 151, 219, 230, 175, 91, 29, 29, 91, 175, 229, 219, 151,
+    68, 22, 42, 115, 195, 233, 204, 127, 50, 22, 59, 139, 211, 231, 186, 104,
+    37, 26, 77, 160, 222, 225, 167, 84, 29, 34, 97, 179, 228, 215, 147, 67,
+    24, 45, 116, 194, 230, 203, 129, 54, 24, 58, 134, 206, 229, 190, 112, 43,
+    26, 71, 150, 215, 226, 176, 96, 36, 31, 85, 165, 221, 220, 162, 83, 31,
+    37, 98, 177, 225, 213, 149, 72, 28, 44, 111, 187, 227, 206, 137, 63, 27,
+    52, 122, 195, 227, 198, 126, 55, 28, 60, 133, 202, 226, 190, 117, 50, 29,
+    67, 141, 207, 224, 183, 109, 45, 31, 74, 149, 210, 222, 177, 102, 42, 33,
+    80, 155, 213, 220, 171, 97, 40, 35, 85, 159, 214, 217, 167, 93, 39, 38,
+    89, 163, 215, 215, 163, 90, 39, 39, 92, 165, 216, 214, 161, 88, 38, 41,
+    94, 166, 215, 213, 160, 88, 39, 42, 95, 166, 215, 212, 159, 88, 40, 42,
+    94, 165, 214, 212, 160, 90, 41, 42, 93, 163, 212, 212, 162, 92, 43, 42,
+    91, 160, 210, 212, 165, 96, 45, 42, 88, 156, 208, 213, 168, 100, 48, 41,
+    84, 151, 205, 214, 173, 106, 51, 40, 79, 145, 201, 214, 177, 112, 55, 40,
+    74, 138, 196, 214, 183, 120, 61, 40, 68, 130, 190, 214, 188, 128, 67, 41,
+    63, 121, 183, 213, 194, 137, 75, 42, 57, 112, 174, 210, 199, 147, 84, 45,
+    52, 101, 165, 206, 204, 158, 95, 50, 48, 91, 153, 201, 207, 168, 107, 57,
+    46, 80, 141, 193, 209, 179, 120, 65, 45, 71, 127, 184, 208, 188, 134, 76,
+    47, 62, 113, 172, 206, 196, 148, 89, 51, 55, 99, 158, 200, 201, 162, 103,
+    58, 51, 85, 143, 192, 205, 175, 119, 68, 49, 73, 126, 180, 204, 186, 136,
+    81, 51, 63, 109, 165, 200, 195, 153, 97, 57, 56, 93, 149, 192, 200, 169,
+    115, 67, 53, 78, 130, 180, 201, 182, 133, 81, 54, 66, 111, 164, 197, 192,
+    152, 99, 61, 59, 93, 146, 188, 198, 169, 118, 72, 56, 77, 125, 174, 197,
+    183, 139, 89, 59, 66, 105, 156, 191, 192, 158, 108, 68, 59, 87, 135, 179,
+    195, 175, 130, 83, 60, 72, 114, 162, 191, 187, 151, 102, 67, 64, 94, 141,
+    181, 192, 169, 124, 81, 62, 77, 119, 164, 190, 183, 146, 100, 68, 67, 97,
+    143, 180, 189, 166, 123, 82, 65, 80, 120, 163, 187, 180, 145, 101, 71, 70,
+    98, 142, 177, 187, 165, 124, 85, 68, 81, 118, 160, 184, 179, 147, 105, 75,
+    71, 97, 137, 172, 184, 166, 128, 90, 71, 81, 114, 154, 180, 178, 151, 112,
+    80, 73, 93, 131, 166, 181, 169, 135, 98, 76, 80, 108, 145, 173, 178, 156,
+    120, 88, 76, 89, 122, 157, 177, 171, 143, 107, 82, 79, 101, 135, 165, 176,
+    162, 130, 98, 80, 86, 113, 146, 170, 172, 151, 119, 91, 81, 94, 124, 154,
+    171, 166, 141, 110, 87, 85, 103, 133, 160, 170, 158, 131, 103, 86, 90, 112,
+    141, 163, 167, 151, 123, 98, 88, 97, 120, 147, 164, 162, 143, 117, 96, 90,
+    103, 127, 151, 163, 156, 136, 112, 95, 94, 110, 133, 153, 160, 151, 130, 108,
+    96, 99, 115, 137, 153, 157, 145, 126, 107, 98, 104, 120, 140, 152, 152, 140,
+    122, 107, 102, 109, 124, 140, 150, 148, 136, 120, 109, 106, 114, 127, 140, 146,
+    143, 132, 120, 112, 112, 118, 128, 137, 140, 137, 129, 122, 118, 120, 124, 128,
+};
+
+#endif
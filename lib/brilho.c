@@ -0,0 +1,48 @@
+#include "brilho.h"
+
+#define BRILHO_ADC_MAX 4096
+#define BRILHO_LARGURA (BRILHO_ADC_MAX / BRILHO_NIVEIS) // Contagens por nível
+
+// Passos perceptualmente uniformes (28% a 100%) elevados à gama 2,2.
+// A matriz vai até 64: acima disso o WS2812 ofusca e o consumo sobe sem ganho de leitura.
+static const uint8_t gama_leds[BRILHO_NIVEIS] = {4, 8, 13, 20, 28, 39, 50, 64};
+static const uint8_t gama_contraste[BRILHO_NIVEIS] = {15, 31, 52, 79, 113, 154, 201, 255};
+
+void brilho_init(brilho_t *b) {
+    b->filtrado = 0;
+    b->nivel = 0;
+    b->iniciado = false;
+}
+
+bool brilho_update(brilho_t *b, uint16_t amostra) {
+    uint32_t x = (uint32_t)amostra << 8;
+    uint8_t anterior = b->nivel;
+
+    if (!b->iniciado) {
+        // Primeira leitura: sem rampa desde o escuro no boot
+        b->filtrado = x;
+        b->nivel = amostra / BRILHO_LARGURA;
+        b->iniciado = true;
+        return true;
+    }
+
+    // y += (x - y) / 2^k, em inteiros com sinal para a descida
+    b->filtrado = (uint32_t)((int32_t)b->filtrado + (((int32_t)x - (int32_t)b->filtrado) >> BRILHO_FILTRO_SHIFT));
+    uint32_t y = b->filtrado >> 8;
+
+    // Só muda de nível quando a leitura passa da fronteira mais a margem
+    if (b->nivel + 1 < BRILHO_NIVEIS && y >= (uint32_t)(b->nivel + 1) * BRILHO_LARGURA + BRILHO_HISTERESE) {
+        b->nivel = y / BRILHO_LARGURA;
+    } else if (b->nivel > 0 && y + BRILHO_HISTERESE < (uint32_t)b->nivel * BRILHO_LARGURA) {
+        b->nivel = y / BRILHO_LARGURA;
+    }
+    return b->nivel != anterior;
+}
+
+uint8_t brilho_leds(uint8_t nivel) {
+    return gama_leds[nivel < BRILHO_NIVEIS ? nivel : BRILHO_NIVEIS - 1];
+}
+
+uint8_t brilho_contraste(uint8_t nivel) {
+    return gama_contraste[nivel < BRILHO_NIVEIS ? nivel : BRILHO_NIVEIS - 1];
+}
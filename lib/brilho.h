@@ -0,0 +1,27 @@
+#ifndef BRILHO_H
+#define BRILHO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Brilho adaptativo: filtro IIR em ponto fixo sobre a leitura do sensor de luz,
+// quantizado em níveis com histerese, e tabelas com correção de gama para a
+// matriz WS2812 e o contraste do OLED
+#define BRILHO_NIVEIS 8
+#define BRILHO_FILTRO_SHIFT 5 // Constante de tempo de 32 atualizações (3,2 s a cada TICK_MS)
+#define BRILHO_HISTERESE 64   // Margem além da fronteira do nível, em contagens do ADC (12 bits)
+
+typedef struct {
+    uint32_t filtrado; // Leitura filtrada em Q8
+    uint8_t nivel;
+    bool iniciado;
+} brilho_t;
+
+void brilho_init(brilho_t *b);
+// amostra: média do ADC (0..4095, maior = mais claro). Retorna true quando o nível muda.
+bool brilho_update(brilho_t *b, uint16_t amostra);
+
+uint8_t brilho_leds(uint8_t nivel);      // Intensidade de cada canal aceso da matriz
+uint8_t brilho_contraste(uint8_t nivel); // Valor de SET_CONTRAST do OLED
+
+#endif
@@ -0,0 +1,251 @@
+#include "caixa_preta.h"
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#include "hardware/watchdog.h"
+#include "hardware/structs/vreg_and_chip_reset.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define CAIXA_PRETA_MAGIC 0x43505232u // "CPR2": anel contínuo entre boots
+#define CAIXA_PRETA_RESET_WATCHDOG (1u << 0) // Junto dos bits HAD_* de chip_reset
+
+// Fora do .bss: o crt0 não zera esta seção
+static caixa_preta_t __uninitialized_ram(caixa);
+
+// Do boot anterior só a falha é copiada; os eventos dele continuam no anel,
+// entre anterior_inicio e caixa.inicio, até o boot atual sobrescrevê-los
+static caixa_preta_falha_t anterior_falha;
+static uint32_t anterior_boots;
+static uint32_t anterior_inicio;
+static bool tem_anterior;
+static const estado_pub_t *estado_pub;
+
+// Divisão de 32 bits (divisor do SIO), também no caminho da preempção. Volta a
+// zero a cada ~71 min, o que basta para ordenar os últimos eventos.
+static uint32_t agora_ms(void) {
+    return time_us_32() / 1000;
+}
+
+void caixa_preta_iniciar(const estado_pub_t *estado) {
+    estado_pub = estado;
+    uint32_t reset = vreg_and_chip_reset_hw->chip_reset;
+    if (watchdog_caused_reboot()) {
+        reset |= CAIXA_PRETA_RESET_WATCHDOG;
+    }
+
+    tem_anterior = caixa.magic == CAIXA_PRETA_MAGIC && caixa.magic_fim == CAIXA_PRETA_MAGIC &&
+                   caixa.inicio <= caixa.indice;
+    if (tem_anterior) {
+        anterior_falha = caixa.falha;
+        anterior_boots = caixa.boots;
+        anterior_inicio = caixa.inicio;
+        caixa.inicio = caixa.indice;
+        caixa.boots++;
+        memset(&caixa.falha, 0, sizeof(caixa.falha));
+    } else {
+        memset(&caixa, 0, sizeof(caixa));
+        caixa.boots = 1;
+        caixa.magic = CAIXA_PRETA_MAGIC;
+        caixa.magic_fim = CAIXA_PRETA_MAGIC;
+    }
+    caixa.reset = reset;
+    caixa_preta_evento(CAIXA_PRETA_EVT_BOOT, tem_anterior ? anterior_falha.motivo : CAIXA_PRETA_OK, 0);
+}
+
+void caixa_preta_evento(uint8_t tipo, uint8_t a, uint16_t b) {
+    uint32_t i = caixa.indice;
+    caixa_preta_evento_t *e = &caixa.eventos[i & (CAIXA_PRETA_EVENTOS - 1)];
+    e->t_ms = agora_ms();
+    e->tipo = tipo;
+    e->a = a;
+    e->b = b;
+    caixa.indice = i + 1;
+}
+
+// Cópia limitada e sempre terminada; de caminhos só o nome do arquivo
+static void copiar(char *dst, size_t tam, const char *src) {
+    if (src == NULL) {
+        dst[0] = '\0';
+        return;
+    }
+    const char *barra = strrchr(src, '/');
+    strncpy(dst, barra != NULL ? barra + 1 : src, tam - 1);
+    dst[tam - 1] = '\0';
+}
+
+// Tarefa comum, escalonador rodando e interrupções habilitadas: só então é
+// seguro percorrer as listas do kernel
+static bool contexto_de_tarefa(void) {
+    uint32_t primask;
+    __asm volatile("mrs %0, primask" : "=r"(primask));
+    return __get_current_exception() == 0 && (primask & 1) == 0 &&
+           xTaskGetSchedulerState() == taskSCHEDULER_RUNNING;
+}
+
+static void capturar_tarefas(caixa_preta_falha_t *f) {
+    static TaskStatus_t status[CAIXA_PRETA_TAREFAS];
+    if (!contexto_de_tarefa()) {
+        return;
+    }
+    UBaseType_t n = uxTaskGetSystemState(status, CAIXA_PRETA_TAREFAS, NULL); // 0 se houver mais tarefas
+    for (UBaseType_t i = 0; i < n; i++) {
+        caixa_preta_tarefa_t *t = &f->tarefas[i];
+        copiar(t->nome, sizeof(t->nome), status[i].pcTaskName);
+        t->estado = (uint8_t)status[i].eCurrentState;
+        t->prioridade = (uint8_t)status[i].uxCurrentPriority;
+        t->pilha_livre = (uint16_t)status[i].usStackHighWaterMark;
+    }
+    f->num_tarefas = (uint8_t)n;
+}
+
+// Só a primeira falha é registrada: uma falha dentro do gancho não apaga a original
+static caixa_preta_falha_t *registrar(uint8_t motivo, const char *tarefa, const char *texto, uint32_t linha) {
+    caixa_preta_falha_t *f = &caixa.falha;
+    if (f->motivo != CAIXA_PRETA_OK) {
+        return NULL;
+    }
+    f->motivo = motivo;
+    f->t_ms = agora_ms();
+    if (tarefa == NULL && xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED) {
+        tarefa = pcTaskGetName(NULL);
+    }
+    copiar(f->tarefa, sizeof(f->tarefa), tarefa);
+    copiar(f->texto, sizeof(f->texto), texto);
+    f->linha = linha;
+    f->heap_livre = xPortGetFreeHeapSize();
+    if (estado_pub != NULL) {
+        f->estado = estado_pub->dados; // Leitura direta: numa falha não há por que repetir o seqlock
+    }
+    caixa_preta_evento(CAIXA_PRETA_EVT_FALHA, motivo, (uint16_t)linha);
+    return f;
+}
+
+static void __attribute__((noreturn)) reiniciar(void) {
+    watchdog_reboot(0, 0, 1);
+    while (true) {
+        tight_loop_contents();
+    }
+}
+
+void caixa_preta_assert(const char *arquivo, int linha) {
+    caixa_preta_falha_t *f = registrar(CAIXA_PRETA_ASSERT, NULL, arquivo, (uint32_t)linha);
+    if (f != NULL) capturar_tarefas(f);
+    reiniciar();
+}
+
+// Chamado pelo kernel na troca de contexto (configCHECK_FOR_STACK_OVERFLOW = 2)
+void vApplicationStackOverflowHook(TaskHandle_t tarefa, char *nome) {
+    (void)tarefa;
+    registrar(CAIXA_PRETA_PILHA, nome, NULL, 0);
+    reiniciar();
+}
+
+void vApplicationMallocFailedHook(void) {
+    caixa_preta_falha_t *f = registrar(CAIXA_PRETA_MEMORIA, NULL, NULL, 0);
+    if (f != NULL) capturar_tarefas(f);
+    reiniciar();
+}
+
+// panic() do SDK, ligado por PICO_PANIC_FUNCTION; guarda o formato sem formatar
+void __attribute__((noreturn)) caixa_preta_panic(const char *fmt, ...) {
+    caixa_preta_falha_t *f = registrar(CAIXA_PRETA_PANIC, NULL, fmt, 0);
+    if (f != NULL) capturar_tarefas(f);
+    reiniciar();
+}
+
+// HardFault: o M0+ não tem registradores de status de falha (CFSR/HFSR); o que
+// sobra é o quadro empilhado na entrada da exceção, com pc e lr da instrução
+void __attribute__((used, noreturn)) caixa_preta_hardfault(const uint32_t *quadro) {
+    caixa_preta_falha_t *f = registrar(CAIXA_PRETA_HARDFAULT, NULL, NULL, 0);
+    uintptr_t sp = (uintptr_t)quadro;
+    if (f != NULL) {
+        f->sp = (uint32_t)sp;
+        if (sp >= SRAM_BASE && sp + sizeof(f->regs) <= SRAM_END) { // Pilha corrompida: sem leitura
+            memcpy(f->regs, quadro, sizeof(f->regs));
+        }
+    }
+    reiniciar();
+}
+
+// Escolhe a pilha em uso na falha (bit 2 do EXC_RETURN: PSP nas tarefas, MSP
+// nas interrupções) e segue para o tratamento em C
+void __attribute__((naked)) isr_hardfault(void) {
+    __asm volatile(
+        "movs r0, #4\n"
+        "mov r1, lr\n"
+        "tst r0, r1\n"
+        "beq 1f\n"
+        "mrs r0, psp\n"
+        "b 2f\n"
+        "1:\n"
+        "mrs r0, msp\n"
+        "2:\n"
+        "bl caixa_preta_hardfault\n"); // Não retorna: o lr perdido não faz falta
+}
+
+static const char *const motivos[] = {
+    "nenhuma", "estouro de pilha", "sem memoria", "assert", "hardfault", "panic",
+};
+static const char *const tipos[] = {"?", "boot", "fase", "preempcao", "falha"};
+static const char *const estados_tarefa[] = {"executando", "pronta", "bloqueada", "suspensa", "removida", "?"};
+
+#define NOME(tabela, i) ((i) < sizeof(tabela) / sizeof(tabela[0]) ? tabela[i] : "?")
+
+static const char *causa_reset(uint32_t reset) {
+    if (reset & CAIXA_PRETA_RESET_WATCHDOG) return "watchdog";
+    if (reset & VREG_AND_CHIP_RESET_CHIP_RESET_HAD_RUN_BITS) return "pino RUN";
+    if (reset & VREG_AND_CHIP_RESET_CHIP_RESET_HAD_PSM_RESTART_BITS) return "depurador";
+    if (reset & VREG_AND_CHIP_RESET_CHIP_RESET_HAD_POR_BITS) return "energia";
+    return "?";
+}
+
+// Eventos de [inicio, fim) que o anel ainda guarda
+static void dump_eventos(uint32_t inicio, uint32_t fim) {
+    // Mais antigo ainda no anel; antes dele, o boot atual já sobrescreveu
+    uint32_t primeiro = caixa.indice - inicio > CAIXA_PRETA_EVENTOS ? caixa.indice - CAIXA_PRETA_EVENTOS : inicio;
+    uint32_t n = caixa.indice - primeiro > caixa.indice - fim ? fim - primeiro : 0;
+    printf("  %lu eventos, ultimos %lu:\n", (unsigned long)(fim - inicio), (unsigned long)n);
+    for (uint32_t k = fim - n; k != fim; k++) {
+        const caixa_preta_evento_t *e = &caixa.eventos[k & (CAIXA_PRETA_EVENTOS - 1)];
+        printf("  %10lu ms %-9s %u %u\n", (unsigned long)e->t_ms, NOME(tipos, e->tipo), e->a, e->b);
+    }
+}
+
+static void dump_falha(const caixa_preta_falha_t *f) {
+    printf("  falha: %s na tarefa '%s' em %lu ms", NOME(motivos, f->motivo), f->tarefa, (unsigned long)f->t_ms);
+    if (f->texto[0] != '\0') printf(" (%s:%lu)", f->texto, (unsigned long)f->linha);
+    printf("\n  modo %u fase %u restante %lu ms, heap livre %lu\n", f->estado.mode, f->estado.phase,
+           (unsigned long)f->estado.time_remaining_ms, (unsigned long)f->heap_livre);
+    if (f->motivo == CAIXA_PRETA_HARDFAULT) {
+        printf("  pc %08lx lr %08lx xpsr %08lx sp %08lx\n", (unsigned long)f->regs[6], (unsigned long)f->regs[5],
+               (unsigned long)f->regs[7], (unsigned long)f->sp);
+        printf("  r0 %08lx r1 %08lx r2 %08lx r3 %08lx r12 %08lx\n", (unsigned long)f->regs[0],
+               (unsigned long)f->regs[1], (unsigned long)f->regs[2], (unsigned long)f->regs[3],
+               (unsigned long)f->regs[4]);
+    }
+    for (uint8_t i = 0; i < f->num_tarefas && i < CAIXA_PRETA_TAREFAS; i++) {
+        const caixa_preta_tarefa_t *t = &f->tarefas[i];
+        printf("  tarefa %-12.12s %-10s prio %u pilha livre %u\n", t->nome, NOME(estados_tarefa, t->estado),
+               t->prioridade, t->pilha_livre);
+    }
+}
+
+void caixa_preta_dump(bool anel_atual) {
+    printf("Caixa preta: boot %lu, reset por %s\n", (unsigned long)caixa.boots, causa_reset(caixa.reset));
+    if (!tem_anterior) {
+        printf("Caixa preta: sem registro do boot anterior\n");
+    } else {
+        printf("Caixa preta: boot anterior (%lu)\n", (unsigned long)anterior_boots);
+        if (anterior_falha.motivo != CAIXA_PRETA_OK) {
+            dump_falha(&anterior_falha);
+        } else {
+            printf("  nenhuma falha registrada\n");
+        }
+        dump_eventos(anterior_inicio, caixa.inicio);
+    }
+    if (anel_atual) {
+        printf("Caixa preta: boot atual\n");
+        dump_eventos(caixa.inicio, caixa.indice);
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef CAIXA_PRETA_H
+#define CAIXA_PRETA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "estado.h"
+
+// Caixa preta: anel dos últimos eventos e registro da última falha numa área de
+// RAM que o boot não zera (.uninitialized_data). Sobrevive a resets por
+// watchdog, pelo pino RUN e aos reinícios feitos aqui mesmo após uma falha; só
+// uma queda de energia a apaga. O conteúdo do boot anterior é mostrado pela USB.
+
+#define CAIXA_PRETA_EVENTOS 64 // Potência de 2
+#define CAIXA_PRETA_TAREFAS 10
+#define CAIXA_PRETA_TEXTO 32
+
+// Tipos de evento do anel
+enum {
+    CAIXA_PRETA_EVT_BOOT = 1, // a = motivo da falha anterior
+    CAIXA_PRETA_EVT_FASE,     // a = modo, b = fase
+    CAIXA_PRETA_EVT_PREEMPCAO,// a = 1 início, 0 fim; b = latência em us (saturada)
+    CAIXA_PRETA_EVT_FALHA,    // a = motivo
+};
+
+// Motivos de falha
+enum {
+    CAIXA_PRETA_OK = 0,
+    CAIXA_PRETA_PILHA,     // Estouro de pilha detectado pelo FreeRTOS
+    CAIXA_PRETA_MEMORIA,   // pvPortMalloc sem memória
+    CAIXA_PRETA_ASSERT,    // configASSERT
+    CAIXA_PRETA_HARDFAULT,
+    CAIXA_PRETA_PANIC,     // panic() do SDK
+};
+
+typedef struct {
+    uint32_t t_ms;
+    uint8_t tipo;
+    uint8_t a;
+    uint16_t b;
+} caixa_preta_evento_t;
+
+typedef struct {
+    char nome[12];
+    uint8_t estado;      // eTaskState
+    uint8_t prioridade;
+    uint16_t pilha_livre; // Menor folga já vista, em palavras
+} caixa_preta_tarefa_t;
+
+typedef struct {
+    uint8_t motivo;
+    uint8_t num_tarefas;
+    char tarefa[12];                // Tarefa em execução (ou com a pilha estourada)
+    char texto[CAIXA_PRETA_TEXTO];  // Arquivo do assert ou mensagem do panic
+    uint32_t linha;
+    uint32_t t_ms;
+    uint32_t regs[8];               // HardFault: r0-r3, r12, lr, pc, xpsr empilhados
+    uint32_t sp;
+    uint32_t heap_livre;
+    estado_t estado;                // Última fase publicada pela matriz
+    caixa_preta_tarefa_t tarefas[CAIXA_PRETA_TAREFAS];
+} caixa_preta_falha_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t boots;
+    uint32_t indice; // Total de eventos gravados; o anel guarda os últimos
+    uint32_t inicio; // Índice do primeiro evento deste boot: o anel segue entre boots
+    uint32_t reset;  // Causa do reset deste boot (registrada no início)
+    caixa_preta_evento_t eventos[CAIXA_PRETA_EVENTOS];
+    caixa_preta_falha_t falha;
+    uint32_t magic_fim;
+} caixa_preta_t;
+
+// Primeira coisa do main: guarda a falha do boot anterior e continua o anel a
+// partir dos eventos dele, que ficam visíveis até serem sobrescritos.
+// estado: instantâneo publicado pela matriz, copiado para o registro de falha.
+void caixa_preta_iniciar(const estado_pub_t *estado);
+
+// Grava um evento: alguns ciclos, sem bloqueio. Um escritor por vez (a tarefa
+// da matriz); os ganchos de falha só escrevem quando o sistema já parou.
+void caixa_preta_evento(uint8_t tipo, uint8_t a, uint16_t b);
+
+// Imprime pela USB o registro do boot anterior (só os eventos ainda no anel) e,
+// se pedido, os eventos do boot atual
+void caixa_preta_dump(bool anel_atual);
+
+// Ganchos: registram a falha e reiniciam pelo watchdog
+void caixa_preta_assert(const char *arquivo, int linha);
+
+#endif
@@ -0,0 +1,43 @@
+#include "energia.h"
+
+static const char *const nomes_modo[NUM_MODES] = {"Normal", "Noturno", "Alto Fluxo", "Baixo Fluxo"};
+
+const char *energia_nome_modo(uint8_t mode) {
+    return mode < NUM_MODES ? nomes_modo[mode] : "?";
+}
+
+uint32_t energia_soma_quadro(const uint32_t frame[NUM_LEDS]) {
+    uint32_t soma = 0;
+    for (int i = 0; i < NUM_LEDS; i++) {
+        uint32_t grb = frame[i] >> 8;
+        soma += (grb & 0xFF) + ((grb >> 8) & 0xFF) + (grb >> 16);
+    }
+    return soma;
+}
+
+uint32_t energia_permil(uint64_t ativo, uint64_t total) {
+    return total ? (uint32_t)(ativo * 1000 / total) : 0;
+}
+
+// Corrente média de uma carga de corrente_ua ativa por ativo_ms em total_ms
+static uint32_t media_ua(uint64_t ativo_ms, uint32_t corrente_ua, uint32_t total_ms) {
+    return (uint32_t)(ativo_ms * corrente_ua / total_ms);
+}
+
+bool energia_consumo(const energia_modo_t *m, energia_consumo_t *c) {
+    uint32_t t = m->tempo_ms;
+    if (t == 0) {
+        return false;
+    }
+    c->base_ua = ENERGIA_BASE_UA;
+    c->cpu_ua = media_ua(m->cpu_ms, ENERGIA_CPU_UA, t);
+    c->matriz_ua = NUM_LEDS * ENERGIA_WS2812_REPOUSO_UA +
+                   (uint32_t)(m->matriz_contagem_ms * ENERGIA_WS2812_CANAL_UA / 255 / t);
+    c->rgb_ua = media_ua((uint64_t)m->rgb_ms[0] + m->rgb_ms[1] + m->rgb_ms[2], ENERGIA_RGB_CANAL_UA, t);
+    c->buzzer_ua = media_ua(m->buzzer_ms, ENERGIA_BUZZER_UA, t);
+    // nC / ms = µA
+    c->i2c_ua = (uint32_t)((uint64_t)m->i2c_bytes * ENERGIA_I2C_NC_BYTE / t);
+    c->oled_ua = ENERGIA_OLED_UA;
+    c->total_ua = c->base_ua + c->cpu_ua + c->matriz_ua + c->rgb_ua + c->buzzer_ua + c->i2c_ua + c->oled_ua;
+    return true;
+}
@@ -0,0 +1,61 @@
+#ifndef ENERGIA_H
+#define ENERGIA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "semaforo.h"
+#include "matriz.h"
+
+// Contabilidade de energia por periférico e por modo. As tarefas somam tempos
+// de atividade e bytes; o modelo abaixo converte em corrente média, que é o
+// consumo em mAh por hora de operação naquele modo.
+//
+// Correntes típicas da BitDog Lab em 3,3 V, em µA. São estimativas de folha de
+// dados: calibre com um medidor na placa antes de dimensionar a fonte.
+#define ENERGIA_BASE_UA 25000          // RP2040 a 125 MHz com o ocioso girando, regulador, USB
+#define ENERGIA_CPU_UA 5000            // Acréscimo com a CPU fora da tarefa ociosa (barramento, flash XIP)
+#define ENERGIA_WS2812_REPOUSO_UA 700  // Por LED, mesmo apagado
+#define ENERGIA_WS2812_CANAL_UA 16000  // Por canal em 255 (proporcional à intensidade)
+#define ENERGIA_RGB_CANAL_UA 6000      // LED RGB, por canal aceso
+#define ENERGIA_BUZZER_UA 25000        // Os dois buzzers com o PWM ativo
+#define ENERGIA_OLED_UA 8000           // Painel ligado, conteúdo típico
+#define ENERGIA_I2C_NC_BYTE 10         // Pull-ups durante um byte a 400 kHz (nC)
+
+// Contadores de um modo. Cada campo tem um único escritor.
+typedef struct {
+    uint32_t tempo_ms;           // Tempo no modo (tarefa da matriz)
+    uint64_t matriz_contagem_ms; // Σ intensidade (0..255) de cada canal × ms aceso
+    uint32_t rgb_ms[3];          // LED RGB: R, G e B acesos
+    uint32_t buzzer_ms;          // PWM dos buzzers ativo
+    uint32_t i2c_bytes;          // Bytes enviados ao display
+    uint32_t cpu_ms;             // CPU fora da tarefa ociosa
+} energia_modo_t;
+
+typedef struct {
+    energia_modo_t modo[NUM_MODES];
+} energia_t;
+
+// Corrente média por componente em µA (= µAh por hora no modo)
+typedef struct {
+    uint32_t base_ua;
+    uint32_t cpu_ua;
+    uint32_t matriz_ua;
+    uint32_t rgb_ua;
+    uint32_t buzzer_ua;
+    uint32_t i2c_ua;
+    uint32_t oled_ua;
+    uint32_t total_ua;
+} energia_consumo_t;
+
+const char *energia_nome_modo(uint8_t mode);
+
+// Soma das intensidades dos canais de um quadro da matriz (palavras já alinhadas, cor << 8)
+uint32_t energia_soma_quadro(const uint32_t frame[NUM_LEDS]);
+
+// Retorna false se o modo ainda não acumulou tempo
+bool energia_consumo(const energia_modo_t *m, energia_consumo_t *c);
+
+// Fração de tempo ativo em milésimos (ex.: 250 = 25,0%)
+uint32_t energia_permil(uint64_t ativo, uint64_t total);
+
+#endif
@@ -0,0 +1,36 @@
+#include "estado.h"
+
+// Cada campo é lido e escrito com acessos atômicos relaxados (sem leituras
+// rasgadas de um campo isolado); as barreiras ordenam os campos em relação a
+// seq, o que vale também entre os dois núcleos com o FreeRTOS SMP.
+
+void estado_publish(estado_pub_t *p, const estado_t *e) {
+    uint32_t seq = __atomic_load_n(&p->seq, __ATOMIC_RELAXED);
+    __atomic_store_n(&p->seq, seq + 1, __ATOMIC_RELAXED); // Ímpar: leitores vão repetir
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    __atomic_store_n(&p->dados.mode, e->mode, __ATOMIC_RELAXED);
+    __atomic_store_n(&p->dados.phase, e->phase, __ATOMIC_RELAXED);
+    __atomic_store_n(&p->dados.time_remaining_ms, e->time_remaining_ms, __ATOMIC_RELAXED);
+
+    __atomic_store_n(&p->seq, seq + 2, __ATOMIC_RELEASE); // Par: novo instantâneo pronto
+}
+
+// O escritor (vMatrixLedTask) tem prioridade maior que os leitores, então num
+// único núcleo um leitor nunca o interrompe no meio da escrita; com SMP a
+// escrita do outro núcleo termina em poucos ciclos. Não chamar de uma ISR.
+uint32_t estado_read(const estado_pub_t *p, estado_t *out) {
+    uint32_t retries = 0;
+    uint32_t s1, s2;
+    while (true) {
+        s1 = __atomic_load_n(&p->seq, __ATOMIC_ACQUIRE);
+        out->mode = __atomic_load_n(&p->dados.mode, __ATOMIC_RELAXED);
+        out->phase = __atomic_load_n(&p->dados.phase, __ATOMIC_RELAXED);
+        out->time_remaining_ms = __atomic_load_n(&p->dados.time_remaining_ms, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        s2 = __atomic_load_n(&p->seq, __ATOMIC_RELAXED);
+        if (!(s1 & 1u) && s1 == s2) break;
+        retries++;
+    }
+    return retries;
+}
@@ -0,0 +1,25 @@
+#ifndef ESTADO_H
+#define ESTADO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Estado do controlador visto pelas tarefas de saída
+typedef struct {
+    uint8_t mode;
+    uint8_t phase;
+    uint32_t time_remaining_ms;
+} estado_t;
+
+// Publicação por sequence lock: um único escritor, leitores sem bloqueio.
+// seq par = estável, ímpar = escrita em andamento.
+typedef struct {
+    uint32_t seq;
+    estado_t dados;
+} estado_pub_t;
+
+void estado_publish(estado_pub_t *p, const estado_t *e);
+// Retorna o número de releituras necessárias (0 = leitura limpa)
+uint32_t estado_read(const estado_pub_t *p, estado_t *out);
+
+#endif
@@ -1,4 +1,5 @@
-static uint8_t font[] = {
+// const: a fonte fica na flash (XIP) em vez de ser copiada para a SRAM
+static const uint8_t font[] = {
 
 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, //  
 0x00, 0x00, 0x00, 0x5F, 0x5F, 0x00, 0x00, 0x00, // !
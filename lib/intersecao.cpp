@@ -0,0 +1,203 @@
+#include "FreeRTOS.h"
+#include "intersecao.h"
+#include "intersecao.hpp"
+#include "semaforo.h"
+
+using namespace intersecao;
+
+// Cruzamento de demonstração: uma linha da matriz 5x5 por grupo focal. Numa
+// instalação real cada segmento é um trecho da mesma cadeia WS2812.
+enum : uint8_t { PRINCIPAL, SECUNDARIA, CONVERSAO, PEDESTRE, NUM_GRUPOS };
+
+#define VERMELHO_GERAL_MS 2000 // Todos em vermelho ao iniciar ou trocar de modo
+
+static constexpr Config<NUM_GRUPOS> config = {
+    {{
+        {"Principal", Tipo::Veicular, 3000, 0, 5},
+        {"Secundaria", Tipo::Veicular, 3000, 5, 5},
+        {"Conversao", Tipo::Conversao, 3000, 10, 5},
+        {"Pedestre", Tipo::Pedestre, 5000, 15, 5},
+    }},
+    // Conflitos: a conversão à esquerda da principal cruza a secundária e a
+    // faixa de pedestres; os pedestres atravessam a principal.
+    {{
+        {{false, true, false, true}},
+        {{true, false, true, false}},
+        {{false, true, false, true}},
+        {{true, false, true, false}},
+    }},
+    // Entreverdes em ms: amarelo (ou vermelho piscante) + vermelho de segurança
+    {{
+        {{0, 4000, 0, 4000}},
+        {{4000, 0, 4000, 0}},
+        {{0, 4000, 0, 4000}},
+        {{6000, 0, 6000, 0}},
+    }},
+};
+
+#define G(g) (1u << (g))
+
+// Normal: conversão protegida, principal, secundária com pedestres
+static constexpr Estagio estagios_normal[] = {
+    {G(PRINCIPAL) | G(CONVERSAO), 5000},
+    {G(PRINCIPAL), 15000},
+    {G(SECUNDARIA) | G(PEDESTRE), 20000},
+};
+
+static constexpr Estagio estagios_alto_fluxo[] = {
+    {G(PRINCIPAL) | G(CONVERSAO), 5000},
+    {G(PRINCIPAL), 20000},
+    {G(SECUNDARIA) | G(PEDESTRE), 15000},
+};
+
+static constexpr Estagio estagios_baixo_fluxo[] = {
+    {G(PRINCIPAL) | G(CONVERSAO), 5000},
+    {G(PRINCIPAL), 10000},
+    {G(SECUNDARIA) | G(PEDESTRE), 25000},
+};
+
+#define N_ESTAGIOS(e) (sizeof(e) / sizeof(e[0]))
+
+static_assert(validar_config(config, NUM_LEDS) == Erro::Ok, "configuração do cruzamento inválida");
+static_assert(validar_plano(config, estagios_normal, N_ESTAGIOS(estagios_normal)) == Erro::Ok,
+              "plano normal com grupos conflitantes em verde");
+static_assert(validar_plano(config, estagios_alto_fluxo, N_ESTAGIOS(estagios_alto_fluxo)) == Erro::Ok,
+              "plano de alto fluxo com grupos conflitantes em verde");
+static_assert(validar_plano(config, estagios_baixo_fluxo, N_ESTAGIOS(estagios_baixo_fluxo)) == Erro::Ok,
+              "plano de baixo fluxo com grupos conflitantes em verde");
+
+static Controlador<NUM_GRUPOS> controlador(config);
+
+// Modo noturno: amarelo piscante nos grupos veiculares, pedestres apagados
+static semaforo_t piscante;
+static uint8_t modo_atual;
+static uint32_t tempo_ms; // Base de tempo do vermelho piscante dos pedestres
+
+static void carregar_modo(uint8_t mode) {
+    Erro e = Erro::Ok;
+    modo_atual = mode;
+    semaforo_start(&piscante, MODE_NOTURNO, semaforo_plano(MODE_NOTURNO));
+    switch (mode) {
+        case MODE_NOTURNO:
+            controlador.desligar(); // A volta ao plano recomeça pelo vermelho geral
+            break;
+        case MODE_ALTO_FLUXO:
+            e = controlador.carregar(estagios_alto_fluxo, N_ESTAGIOS(estagios_alto_fluxo), VERMELHO_GERAL_MS);
+            break;
+        case MODE_BAIXO_FLUXO:
+            e = controlador.carregar(estagios_baixo_fluxo, N_ESTAGIOS(estagios_baixo_fluxo), VERMELHO_GERAL_MS);
+            break;
+        default:
+            e = controlador.carregar(estagios_normal, N_ESTAGIOS(estagios_normal), VERMELHO_GERAL_MS);
+            break;
+    }
+    configASSERT(e == Erro::Ok); // Plano recusado deixaria o controlador no plano anterior
+}
+
+uint8_t intersecao_num_grupos(void) {
+    return NUM_GRUPOS;
+}
+
+const char *intersecao_nome(uint8_t grupo) {
+    return config.grupos[grupo].nome;
+}
+
+uint16_t intersecao_amarelo_ms(uint8_t grupo) {
+    return config.grupos[grupo].amarelo_ms;
+}
+
+uint16_t intersecao_entreverdes_ms(uint8_t de, uint8_t para) {
+    return config.conflito[de][para] ? config.entreverdes_ms[de][para] : 0;
+}
+
+void intersecao_start(uint8_t mode) {
+    tempo_ms = 0;
+    controlador.desligar();
+    carregar_modo(mode);
+}
+
+// O noturno só entra depois de controlador.encerrar() cumprir amarelo e entreverdes
+bool intersecao_step(uint8_t mode) {
+    tempo_ms += TICK_MS;
+    if (!intersecao_preemptado()) {
+        if (mode == MODE_NOTURNO && modo_atual != MODE_NOTURNO) {
+            if (!controlador.encerrando()) {
+                controlador.encerrar();
+                return true;
+            }
+        } else if (mode != modo_atual || controlador.encerrando()) {
+            carregar_modo(mode); // Também desiste de um encerramento em curso
+            return true;
+        }
+    }
+    if (modo_atual == MODE_NOTURNO) {
+        return semaforo_step(&piscante, MODE_NOTURNO);
+    }
+    bool mudou = controlador.step(TICK_MS);
+    if (controlador.encerrado() && !controlador.preemptado()) {
+        carregar_modo(MODE_NOTURNO);
+        return true;
+    }
+    return mudou;
+}
+
+uint8_t intersecao_mode(void) {
+    return modo_atual;
+}
+
+bool intersecao_preempt(bool pedida) {
+    if (modo_atual == MODE_NOTURNO) {
+        return semaforo_preempt(&piscante, pedida); // Piscante vira amarelo fixo e depois vermelho
+    }
+    return controlador.preemptar(pedida);
+}
+
+bool intersecao_preemptado(void) {
+    if (modo_atual == MODE_NOTURNO) {
+        return piscante.preempcao != PREEMPCAO_NENHUMA;
+    }
+    return controlador.preemptado();
+}
+
+uint8_t intersecao_phase(uint8_t grupo) {
+    if (modo_atual == MODE_NOTURNO) {
+        if (config.grupos[grupo].tipo != Tipo::Pedestre) {
+            return piscante.phase;
+        }
+        return piscante.preempcao != PREEMPCAO_NENHUMA ? PHASE_VERMELHO : PHASE_PISCANTE_APAGADO;
+    }
+    switch (controlador.sinal(grupo)) {
+        case Sinal::Verde:
+            return PHASE_VERDE;
+        case Sinal::Amarelo:
+            return PHASE_AMARELO;
+        default:
+            return PHASE_VERMELHO;
+    }
+}
+
+uint32_t intersecao_time_remaining_ms(void) {
+    if (modo_atual == MODE_NOTURNO) {
+        return piscante.time_remaining_ms;
+    }
+    return controlador.restante_ms();
+}
+
+void intersecao_compose_frame(uint32_t frame[NUM_LEDS]) {
+    uint32_t off = rgb_to_grb(0, 0, 0) << 8u;
+    for (int i = 0; i < NUM_LEDS; i++) {
+        frame[i] = off; // LEDs fora de qualquer segmento ficam apagados
+    }
+    for (uint8_t g = 0; g < NUM_GRUPOS; g++) {
+        const Grupo &grupo = config.grupos[g];
+        uint8_t phase = intersecao_phase(g);
+        if (grupo.tipo == Tipo::Pedestre && phase == PHASE_AMARELO) {
+            // Pedestres não têm amarelo: vermelho piscando a 1 Hz
+            phase = (tempo_ms / 500) % 2 ? PHASE_PISCANTE_APAGADO : PHASE_VERMELHO;
+        }
+        uint32_t color = matriz_phase_color(phase) << 8u;
+        for (uint8_t i = 0; i < grupo.led_qtd; i++) {
+            frame[grupo.led_inicio + i] = color;
+        }
+    }
+}
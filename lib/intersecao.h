@@ -0,0 +1,47 @@
+#ifndef INTERSECAO_H
+#define INTERSECAO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "matriz.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Cruzamento completo em uma placa: cada grupo focal acende o próprio segmento
+// da cadeia WS2812. Configuração, conflitos e planos ficam em intersecao.cpp.
+
+#define INTERSECAO_GRUPO_PRINCIPAL 0 // Grupo espelhado no LED RGB, no display e nos buzzers
+
+uint8_t intersecao_num_grupos(void);
+const char *intersecao_nome(uint8_t grupo);
+uint16_t intersecao_amarelo_ms(uint8_t grupo);
+// Do fim do verde de um grupo ao início do verde de outro; 0 se não há conflito
+uint16_t intersecao_entreverdes_ms(uint8_t de, uint8_t para);
+
+void intersecao_start(uint8_t mode);
+// Avança um tick de TICK_MS. Uma troca de modo reinicia pelo vermelho geral; a
+// troca para o noturno antes cumpre o amarelo e os entreverdes dos grupos em verde.
+// Retorna true quando o sinal de algum grupo muda.
+bool intersecao_step(uint8_t mode);
+uint8_t intersecao_mode(void); // Modo em vigor (a troca espera o fim de uma preempção)
+
+// Preempção: amarelo de liberação e vermelho geral enquanto pedida; a troca de
+// modo espera a liberação. Retorna true quando o pedido é aplicado ou quando o
+// sinal de algum grupo muda.
+bool intersecao_preempt(bool pedida);
+bool intersecao_preemptado(void);
+
+// Sinal do grupo na mesma codificação PHASE_* do semáforo simples
+uint8_t intersecao_phase(uint8_t grupo);
+// Tempo até o próximo evento do plano (fim do verde do estágio ou do entreverdes)
+uint32_t intersecao_time_remaining_ms(void);
+
+void intersecao_compose_frame(uint32_t frame[NUM_LEDS]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,313 @@
+#ifndef INTERSECAO_HPP
+#define INTERSECAO_HPP
+
+// Motor genérico de cruzamento com N grupos focais (aproximações veiculares,
+// setas de conversão e focos de pedestres). A matriz de conflitos e a tabela
+// de entreverdes são constantes; as funções de validação são constexpr, então
+// a configuração da placa é verificada com static_assert e um plano carregado
+// em tempo de execução passa pela mesma verificação.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace intersecao {
+
+enum class Tipo : uint8_t { Veicular, Conversao, Pedestre };
+
+enum class Sinal : uint8_t { Vermelho, Amarelo, Verde };
+
+struct Grupo {
+    const char *nome;
+    Tipo tipo;
+    uint16_t amarelo_ms;  // Amarelo (veicular) ou vermelho piscante (pedestre)
+    uint8_t led_inicio;   // Segmento WS2812 do grupo
+    uint8_t led_qtd;
+};
+
+template <size_t N>
+struct Config {
+    std::array<Grupo, N> grupos;
+    std::array<std::array<bool, N>, N> conflito;
+    // Do fim do verde de i ao início do verde de j (só para pares em conflito)
+    std::array<std::array<uint16_t, N>, N> entreverdes_ms;
+};
+
+// Estágio: grupos em verde ao mesmo tempo (bit g = grupo g) e duração do verde
+struct Estagio {
+    uint32_t grupos;
+    uint16_t verde_ms;
+};
+
+enum class Erro : uint8_t {
+    Ok,
+    ConflitoConsigo,
+    ConflitoAssimetrico,
+    EntreverdesAusente,
+    EntreverdesCurto,
+    SegmentoInvalido,
+    SegmentoSobreposto,
+    PlanoVazio,
+    EstagioVazio,
+    GrupoInexistente,
+    EstagioComConflito,
+};
+
+template <size_t N>
+constexpr Erro validar_config(const Config<N> &c, size_t num_leds) {
+    static_assert(N <= 32, "Estagio::grupos comporta até 32 grupos");
+    for (size_t i = 0; i < N; i++) {
+        if (c.conflito[i][i]) return Erro::ConflitoConsigo;
+        const Grupo &g = c.grupos[i];
+        if (g.led_qtd == 0 || g.led_inicio + g.led_qtd > num_leds) return Erro::SegmentoInvalido;
+        for (size_t j = 0; j < N; j++) {
+            if (c.conflito[i][j] != c.conflito[j][i]) return Erro::ConflitoAssimetrico;
+            if (c.conflito[i][j]) {
+                if (c.entreverdes_ms[i][j] == 0) return Erro::EntreverdesAusente;
+                // O verde conflitante não pode começar antes do fim do amarelo
+                if (c.entreverdes_ms[i][j] < g.amarelo_ms) return Erro::EntreverdesCurto;
+            }
+            const Grupo &h = c.grupos[j];
+            if (i < j && g.led_inicio < h.led_inicio + h.led_qtd && h.led_inicio < g.led_inicio + g.led_qtd) {
+                return Erro::SegmentoSobreposto;
+            }
+        }
+    }
+    return Erro::Ok;
+}
+
+template <size_t N>
+constexpr Erro validar_plano(const Config<N> &c, const Estagio *estagios, size_t num) {
+    if (num == 0) return Erro::PlanoVazio;
+    for (size_t k = 0; k < num; k++) {
+        uint32_t m = estagios[k].grupos;
+        if (m == 0 || estagios[k].verde_ms == 0) return Erro::EstagioVazio;
+        if (N < 32 && (m >> N) != 0) return Erro::GrupoInexistente;
+        for (size_t i = 0; i < N; i++) {
+            for (size_t j = i + 1; j < N; j++) {
+                if ((m >> i & 1u) && (m >> j & 1u) && c.conflito[i][j]) return Erro::EstagioComConflito;
+            }
+        }
+    }
+    return Erro::Ok;
+}
+
+template <size_t N>
+class Controlador {
+public:
+    constexpr explicit Controlador(const Config<N> &c) : cfg_(c) {}
+
+    // Valida o plano e passa ao primeiro estágio. Os grupos em verde que não
+    // continuam passam pelo amarelo; os que entram esperam o vermelho geral e
+    // os entreverdes dos conflitantes, contados do fim do verde de cada um.
+    Erro carregar(const Estagio *estagios, size_t num, uint16_t vermelho_geral_ms) {
+        Erro e = validar_plano(cfg_, estagios, num);
+        if (e != Erro::Ok) return e;
+        estagios_ = estagios;
+        num_ = num;
+        vermelho_geral_ms_ = vermelho_geral_ms;
+        preempcao_ = false;
+        retido_ = false;
+        encerrando_ = false;
+        atual_ = num - 1;
+        proximo_ = 0;
+        iniciar_transicao(verdes(), estagios_[0].grupos, vermelho_geral_ms);
+        atualizar_sinais();
+        return Erro::Ok;
+    }
+
+    // Avança dt_ms; retorna true se algum sinal mudou
+    bool step(uint32_t dt_ms) {
+        t_ms_ += dt_ms;
+        for (size_t g = 0; g < N; g++) {
+            if (sinais_[g] == Sinal::Verde || (fechados_fora_ >> g & 1u)) continue;
+            if (desde_verde_ms_[g] < UINT32_MAX - dt_ms) desde_verde_ms_[g] += dt_ms;
+        }
+        if (!transicao_ && t_ms_ >= estagios_[atual_].verde_ms) {
+            proximo_ = (atual_ + 1) % num_;
+            iniciar_transicao(estagios_[atual_].grupos, estagios_[proximo_].grupos, 0);
+        }
+        if (transicao_ && t_ms_ >= duracao_ms_) {
+            if (encerrando_) {
+                t_ms_ = duracao_ms_; // Vermelho geral até desligar()
+            } else if (retido_ && preempcao_) {
+                t_ms_ = duracao_ms_; // Vermelho geral mantido
+            } else if (retido_) {
+                // Fim da preempção: retoma pelo estágio seguinte, após o vermelho geral
+                retido_ = false;
+                iniciar_transicao(0, estagios_[proximo_].grupos, vermelho_geral_ms_);
+            } else if (preempcao_) {
+                reter(verdes());
+            } else {
+                atual_ = proximo_;
+                transicao_ = false;
+                t_ms_ = 0;
+            }
+        }
+        bool mudou = atualizar_sinais();
+        fechados_fora_ = 0;
+        return mudou;
+    }
+
+    // Preempção: todos os grupos em verde passam pelo amarelo e o cruzamento
+    // fica em vermelho geral até a liberação. Numa transição, os grupos que
+    // ainda não abriram ficam fechados e os demais são liberados ao final dela.
+    bool preemptar(bool ativo) {
+        if (ativo == preempcao_) return false;
+        preempcao_ = ativo;
+        if (!ativo) return false; // A retomada acontece no step, após o amarelo
+        if (!transicao_) {
+            proximo_ = (atual_ + 1) % num_;
+            reter(estagios_[atual_].grupos);
+        } else if (!retido_) {
+            for (size_t g = 0; g < N; g++) {
+                if (sinais_[g] != Sinal::Verde) inicio_ms_[g] = UINT32_MAX;
+            }
+        }
+        atualizar_sinais();
+        return true; // Mesmo sem sinal novo (vermelho geral), a contagem some
+    }
+
+    bool preemptado() const { return preempcao_ || retido_; }
+
+    // Saída de serviço: os grupos em verde passam pelo amarelo e o cruzamento
+    // fica em vermelho geral até cumprir, para cada grupo, o maior entreverdes
+    // aos conflitantes. Só então desligar() pode apagar os sinais.
+    void encerrar() {
+        encerrando_ = true;
+        retido_ = false;
+        uint32_t saem = verdes();
+        iniciar_transicao(saem, 0, 0);
+        for (size_t g = 0; g < N; g++) {
+            uint32_t passado = (saem >> g & 1u) ? 0 : desde_verde_ms_[g];
+            for (size_t s = 0; s < N; s++) {
+                if (!cfg_.conflito[g][s] || cfg_.entreverdes_ms[g][s] <= passado) continue;
+                uint32_t falta = cfg_.entreverdes_ms[g][s] - passado;
+                duracao_ms_ = falta > duracao_ms_ ? falta : duracao_ms_;
+            }
+        }
+        atualizar_sinais();
+    }
+
+    bool encerrando() const { return encerrando_; }
+    bool encerrado() const { return encerrando_ && t_ms_ >= duracao_ms_; }
+
+    // Fora de serviço (modo piscante): nenhum grupo aberto nem em entreverdes
+    void desligar() {
+        transicao_ = false;
+        preempcao_ = false;
+        retido_ = false;
+        encerrando_ = false;
+        sinais_ = {};
+        desde_verde_ms_ = nunca_verde();
+    }
+
+    Sinal sinal(size_t g) const { return sinais_[g]; }
+
+    // Tempo até o fim do intervalo atual (verde do estágio ou entreverdes)
+    uint32_t restante_ms() const {
+        if (retido_) return 0;
+        uint32_t fim = transicao_ ? duracao_ms_ : estagios_[atual_].verde_ms;
+        return fim > t_ms_ ? fim - t_ms_ : 0;
+    }
+
+    const Config<N> &config() const { return cfg_; }
+
+private:
+    uint32_t verdes() const {
+        uint32_t m = 0;
+        for (size_t g = 0; g < N; g++) {
+            if (sinais_[g] == Sinal::Verde) m |= 1u << g;
+        }
+        return m;
+    }
+
+    void reter(uint32_t de) {
+        retido_ = true;
+        iniciar_transicao(de, 0, 0);
+    }
+
+    void iniciar_transicao(uint32_t de, uint32_t para, uint16_t minimo_ms) {
+        de_ = de;
+        para_ = para;
+        transicao_ = true;
+        t_ms_ = 0;
+        uint32_t entram = para & ~de;
+        uint32_t saem = de & ~para;
+        duracao_ms_ = minimo_ms;
+        for (size_t g = 0; g < N; g++) {
+            inicio_ms_[g] = minimo_ms;
+            if (saem >> g & 1u) {
+                duracao_ms_ = cfg_.grupos[g].amarelo_ms > duracao_ms_ ? cfg_.grupos[g].amarelo_ms : duracao_ms_;
+            }
+        }
+        // Cada grupo que entra espera o maior entreverdes dos grupos conflitantes:
+        // inteiro para os que saem agora, o que falta para os que já saíram
+        for (size_t s = 0; s < N; s++) {
+            if (!(entram >> s & 1u)) continue;
+            for (size_t e = 0; e < N; e++) {
+                if (!cfg_.conflito[e][s]) continue;
+                uint32_t passado = (saem >> e & 1u) ? 0 : desde_verde_ms_[e];
+                uint32_t falta = cfg_.entreverdes_ms[e][s] > passado ? cfg_.entreverdes_ms[e][s] - passado : 0;
+                if (falta > inicio_ms_[s]) inicio_ms_[s] = falta;
+            }
+            duracao_ms_ = inicio_ms_[s] > duracao_ms_ ? inicio_ms_[s] : duracao_ms_;
+        }
+    }
+
+    bool atualizar_sinais() {
+        bool mudou = false;
+        uint32_t verde = transicao_ ? para_ : estagios_[atual_].grupos;
+        for (size_t g = 0; g < N; g++) {
+            bool aberto = false;
+            if (!transicao_ || (de_ >> g & 1u)) {
+                aberto = verde >> g & 1u; // No estágio, ou continua no próximo
+            } else if (verde >> g & 1u) {
+                aberto = t_ms_ >= inicio_ms_[g];
+            }
+            if (!aberto && sinais_[g] == Sinal::Verde) {
+                desde_verde_ms_[g] = 0; // Fim do verde: começa o amarelo e contam os entreverdes
+                fechados_fora_ |= 1u << g;
+            }
+            // O amarelo vem do fim do verde, então sobrevive a uma nova transição
+            Sinal s = aberto                                             ? Sinal::Verde
+                      : desde_verde_ms_[g] < cfg_.grupos[g].amarelo_ms ? Sinal::Amarelo
+                                                                        : Sinal::Vermelho;
+            mudou |= s != sinais_[g];
+            sinais_[g] = s;
+        }
+        return mudou;
+    }
+
+    const Config<N> &cfg_;
+    const Estagio *estagios_ = nullptr;
+    size_t num_ = 0;
+    size_t atual_ = 0;
+    size_t proximo_ = 0;
+    bool transicao_ = false;
+    bool preempcao_ = false;    // Preempção pedida
+    bool retido_ = false;       // Transição atual leva ao vermelho geral da preempção
+    bool encerrando_ = false;   // Transição atual leva ao desligamento
+    uint16_t vermelho_geral_ms_ = 0;
+    uint32_t de_ = 0;           // Grupos em verde quando a transição começou
+    uint32_t para_ = 0;         // Grupos em verde ao fim da transição
+    uint32_t t_ms_ = 0;         // Tempo no intervalo atual
+    uint32_t duracao_ms_ = 0;   // Duração da transição atual
+    std::array<uint32_t, N> inicio_ms_{};
+    std::array<Sinal, N> sinais_{};
+    // Tempo desde o fim do verde de cada grupo (saturado; nunca abriu = UINT32_MAX)
+    std::array<uint32_t, N> desde_verde_ms_ = nunca_verde();
+    // Verdes encerrados fora do step (preempção entre ticks): o amarelo só
+    // começa a contar no step seguinte, que não cobre um tick inteiro dele
+    uint32_t fechados_fora_ = 0;
+
+    static constexpr std::array<uint32_t, N> nunca_verde() {
+        std::array<uint32_t, N> a{};
+        for (size_t g = 0; g < N; g++) a[g] = UINT32_MAX;
+        return a;
+    }
+};
+
+}  // namespace intersecao
+
+#endif
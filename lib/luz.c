@@ -0,0 +1,51 @@
+#include "luz.h"
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+
+// 48 MHz / (1 + 65535) = 732 amostras/s: o anel inteiro é renovado a cada ~90 ms
+#define LUZ_ADC_CLKDIV 65535.0f
+
+static uint16_t amostras[LUZ_AMOSTRAS] __attribute__((aligned(LUZ_AMOSTRAS * sizeof(uint16_t))));
+static uint16_t *amostras_inicio = amostras; // Lido pelo canal de recarga
+static uint dma_dados;
+static uint dma_recarga;
+
+void luz_init(void) {
+    adc_init();
+    adc_gpio_init(LUZ_ADC_GPIO);
+    adc_select_input(LUZ_ADC_INPUT);
+    adc_fifo_setup(true, true, 1, false, false); // FIFO com DREQ a cada amostra, 12 bits sem deslocamento
+    adc_set_clkdiv(LUZ_ADC_CLKDIV);
+
+    dma_dados = dma_claim_unused_channel(true);
+    dma_recarga = dma_claim_unused_channel(true);
+
+    // Dados: FIFO do ADC para o anel, no ritmo do DREQ; ao fim de uma volta encadeia a recarga
+    dma_channel_config c = dma_channel_get_default_config(dma_dados);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_ring(&c, true, __builtin_ctz(sizeof(amostras)));
+    channel_config_set_dreq(&c, DREQ_ADC);
+    channel_config_set_chain_to(&c, dma_recarga);
+    dma_channel_configure(dma_dados, &c, amostras, &adc_hw->fifo, LUZ_AMOSTRAS, false);
+
+    // Recarga: reescreve o endereço do anel no alias de disparo do canal de dados,
+    // que recomeça com a contagem original. Sem interrupção e sem fim de contagem.
+    dma_channel_config r = dma_channel_get_default_config(dma_recarga);
+    channel_config_set_transfer_data_size(&r, DMA_SIZE_32);
+    channel_config_set_read_increment(&r, false);
+    channel_config_set_write_increment(&r, false);
+    dma_channel_configure(dma_recarga, &r, &dma_hw->ch[dma_dados].al2_write_addr_trig, &amostras_inicio, 1, false);
+
+    dma_channel_start(dma_dados);
+    adc_run(true);
+}
+
+uint16_t luz_media(void) {
+    uint32_t soma = 0;
+    for (int i = 0; i < LUZ_AMOSTRAS; i++) {
+        soma += amostras[i];
+    }
+    return (uint16_t)(soma / LUZ_AMOSTRAS);
+}
@@ -0,0 +1,23 @@
+#ifndef LUZ_H
+#define LUZ_H
+
+#include <stdint.h>
+
+// Sensor de luz ambiente externo (LDR em divisor: LDR para 3V3, resistor de
+// 10 kΩ para o GND) amostrado continuamente pelo ADC, com o DMA gravando num
+// anel sem CPU. A BitDogLab não tem entrada analógica livre: GPIO 26 e 27 são
+// o joystick e GPIO 28 é o microfone. O pino vem do CMake (SEMAFORO_LUZ_GPIO)
+// e o LDR entra no lugar do que estiver ligado nele, nunca em paralelo.
+#ifndef LUZ_ADC_GPIO
+#error "defina SEMAFORO_LUZ_GPIO (26, 27 ou 28) com o pino do LDR"
+#elif LUZ_ADC_GPIO < 26 || LUZ_ADC_GPIO > 28
+#error "o LDR precisa de um pino de ADC livre: GPIO 26, 27 ou 28"
+#endif
+#define LUZ_ADC_INPUT (LUZ_ADC_GPIO - 26)
+#define LUZ_AMOSTRAS 64 // Potência de 2: anel de escrita do DMA
+
+void luz_init(void);
+// Média do anel (0..4095); a soma custa LUZ_AMOSTRAS leituras de 16 bits
+uint16_t luz_media(void);
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef LWIPOPTS_H
+#define LWIPOPTS_H
+
+// lwIP para a telemetria (pico_cyw43_arch_lwip_sys_freertos): só UDP e DHCP,
+// com a pilha rodando em uma tarefa do FreeRTOS
+#define NO_SYS                      0
+#define LWIP_SOCKET                 0
+#define LWIP_NETCONN                0
+#define MEM_LIBC_MALLOC             0
+#define MEM_ALIGNMENT               4
+#define MEM_SIZE                    4000
+#define MEMP_NUM_TCP_SEG            8
+#define MEMP_NUM_ARP_QUEUE          4
+#define PBUF_POOL_SIZE              8
+#define LWIP_ARP                    1
+#define LWIP_ETHERNET               1
+#define LWIP_ICMP                   1
+#define LWIP_RAW                    0
+#define LWIP_TCP                    0
+#define LWIP_UDP                    1
+#define LWIP_DNS                    0
+#define LWIP_DHCP                   1
+#define LWIP_IPV4                   1
+#define LWIP_NETIF_STATUS_CALLBACK  1
+#define LWIP_NETIF_LINK_CALLBACK    1
+#define LWIP_NETIF_HOSTNAME         1
+#define LWIP_NETIF_TX_SINGLE_PBUF   1
+#define DHCP_DOES_ARP_CHECK         0
+#define LWIP_DHCP_DOES_ACD_CHECK    0
+#define LWIP_CHKSUM_ALGORITHM       3
+#define LWIP_STATS                  0
+#define LWIP_TIMEVAL_PRIVATE        0
+
+// Tarefa tcpip e caixas de mensagem (modo sys_freertos)
+#define TCPIP_THREAD_STACKSIZE      1024
+#define TCPIP_THREAD_PRIO           2 // tskIDLE_PRIORITY + 2: abaixo da vMatrixLedTask (+3), o rádio não atrasa o tick
+#define TCPIP_MBOX_SIZE             8
+#define DEFAULT_THREAD_STACKSIZE    1024
+#define DEFAULT_UDP_RECVMBOX_SIZE   8
+#define DEFAULT_RAW_RECVMBOX_SIZE   8
+#define DEFAULT_TCP_RECVMBOX_SIZE   8
+#define DEFAULT_ACCEPTMBOX_SIZE     8
+#define LWIP_TCPIP_CORE_LOCKING_INPUT 1
+
+#endif
@@ -0,0 +1,74 @@
+#include "matriz.h"
+#include "semaforo.h"
+
+// Padrões dos números 0 a 5 na matriz 5x5, um bit por pixel (bit i = LED i).
+// Só a contagem final (5 a 0) é exibida, então 6 a 9 não são armazenados.
+// Por ser const, a tabela fica na flash (XIP) e não ocupa SRAM.
+static const uint32_t numeros[MATRIZ_NUM_DIGITS] = {
+    0x0E5294E, // 0
+    0x0240902, // 1
+    0x0E4384E, // 2
+    0x0E4190E, // 3
+    0x0A53902, // 4
+    0x0E1390E, // 5
+};
+
+// Intensidade dos canais acesos; ajustada pelo sensor de luz quando presente
+static volatile uint8_t brilho = MATRIZ_BRILHO_PADRAO;
+
+void matriz_set_brilho(uint8_t valor) {
+    brilho = valor;
+}
+
+uint32_t matriz_phase_color(uint8_t phase) {
+    uint8_t b = brilho;
+    switch (phase) {
+        case PHASE_VERDE:
+            return rgb_to_grb(0, b, 0); // Verde
+        case PHASE_AMARELO:
+        case PHASE_PISCANTE_ACESO:
+            return rgb_to_grb(b, b, 0); // Amarelo
+        case PHASE_VERMELHO:
+            return rgb_to_grb(b, 0, 0); // Vermelho
+        default:
+            return rgb_to_grb(0, 0, 0); // Desligado
+    }
+}
+
+void matriz_fill_frame(uint32_t frame[NUM_LEDS], uint32_t color) {
+    for (int i = 0; i < NUM_LEDS; i++) {
+        frame[i] = color << 8u; // Adiciona deslocamento para alinhar os dados
+    }
+}
+
+// Gera o quadro de um número na matriz 5x5
+void matriz_number_frame(uint32_t frame[NUM_LEDS], int number, uint32_t color) {
+    uint32_t off = rgb_to_grb(0, 0, 0) << 8u; // Desligado
+    uint32_t on = color << 8u; // Cor depende da fase (Verde ou Vermelho)
+
+    if (number < 0 || number >= MATRIZ_NUM_DIGITS) {
+        matriz_fill_frame(frame, 0); // Apaga se número inválido
+        return;
+    }
+
+    // Uma única leitura da flash por quadro; os pixels saem dos bits do padrão
+    uint32_t pattern = numeros[number];
+    for (int i = 0; i < NUM_LEDS; i++) {
+        uint32_t mask = 0u - ((pattern >> i) & 1u); // 1 = aceso, 0 = apagado
+        frame[i] = (on & mask) | (off & ~mask);
+    }
+}
+
+// Quadro da matriz para o estado atual do semáforo
+void matriz_compose_frame(uint32_t frame[NUM_LEDS], uint8_t phase, uint32_t time_remaining_ms) {
+    uint32_t color = matriz_phase_color(phase);
+
+    if (phase == PHASE_VERDE || phase == PHASE_VERMELHO) {
+        int remaining_seconds = time_remaining_ms / 1000; // Alinha com o display
+        if (remaining_seconds <= 5) { // Últimos 6 segundos, exibe contagem 5 a 0
+            matriz_number_frame(frame, remaining_seconds, color);
+            return;
+        }
+    }
+    matriz_fill_frame(frame, color); // Cor sólida (ou apagado no piscante)
+}
@@ -0,0 +1,33 @@
+#ifndef MATRIZ_H
+#define MATRIZ_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NUM_LEDS 25 // Matriz 5x5 da BitDog Lab
+#define MATRIZ_NUM_DIGITS 6 // Contagem de 5 a 0
+#define MATRIZ_BRILHO_PADRAO 10 // Intensidade fixa sem sensor de luz
+
+// Funções auxiliares para WS2812
+static inline uint32_t rgb_to_grb(uint8_t r, uint8_t g, uint8_t b) {
+    return ((uint32_t)g << 16) | ((uint32_t)r << 8) | (uint32_t)b; // Ordem GRB
+}
+
+// Cor da matriz para cada fase, na intensidade atual
+uint32_t matriz_phase_color(uint8_t phase);
+void matriz_set_brilho(uint8_t valor);
+
+// Os quadros guardam as palavras já alinhadas para o FIFO do PIO (cor << 8)
+void matriz_fill_frame(uint32_t frame[NUM_LEDS], uint32_t color);
+void matriz_number_frame(uint32_t frame[NUM_LEDS], int number, uint32_t color);
+void matriz_compose_frame(uint32_t frame[NUM_LEDS], uint8_t phase, uint32_t time_remaining_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,97 @@
+#include <stdio.h>
+#include "painel.h"
+#include "semaforo.h"
+
+#define BAR_WIDTH 40 // Largura da barra
+
+// Conteúdo variável da tela: tudo o que painel_render desenha depende só disto
+typedef struct {
+    int seconds_remaining;
+    int filled_width; // -1 = sem barra (modo noturno)
+} painel_layout_t;
+
+static painel_layout_t painel_layout(uint8_t mode, uint8_t phase, uint32_t time_remaining_ms) {
+    painel_layout_t l;
+
+    // Contador de tempo
+    l.seconds_remaining = time_remaining_ms / 1000;
+    if (phase == PHASE_AMARELO) { // Amarelo em qualquer modo
+        l.seconds_remaining = 0; // Zerar o contador para amarelo
+    }
+
+    // Barra de progresso apenas nos modos Normal, Alto Fluxo e Baixo Fluxo
+    l.filled_width = -1;
+    if (mode != MODE_NOTURNO) {
+        l.filled_width = 0;
+        if (phase == PHASE_VERDE || phase == PHASE_VERMELHO) {
+            int total_time_s = 0;
+            if (mode == MODE_NORMAL) {
+                total_time_s = 20; // 20s para Verde e Vermelho
+            } else if (mode == MODE_ALTO_FLUXO) {
+                total_time_s = (phase == PHASE_VERDE) ? 25 : 15; // 25s Verde, 15s Vermelho
+            } else if (mode == MODE_BAIXO_FLUXO) {
+                total_time_s = (phase == PHASE_VERDE) ? 15 : 25; // 15s Verde, 25s Vermelho
+            }
+            l.filled_width = (time_remaining_ms / 1000) * BAR_WIDTH / total_time_s; // Proporcional ao tempo restante
+            if (l.filled_width > BAR_WIDTH) {
+                l.filled_width = BAR_WIDTH; // Estágios do cruzamento podem ser mais longos que a fase
+            }
+        }
+    }
+    return l;
+}
+
+void painel_render(ssd1306_t *ssd, uint8_t mode, uint8_t phase, uint32_t time_remaining_ms) {
+    char state_str[16];
+    char time_str[16];
+    painel_layout_t l = painel_layout(mode, phase, time_remaining_ms);
+
+    // Definir a posição da barra
+    int bar_y_start = (ssd->height == 64) ? 40 : 20; // y=40 para 128x64, y=20 para 128x32
+    int bar_y_end = bar_y_start + 10; // Barra de 10 pixels de altura
+    int bar_x_start = (ssd->width - BAR_WIDTH) / 2; // Centralizado: (128 - 40) / 2 = 44
+
+    // Limpar o display completamente antes de desenhar
+    ssd1306_fill(ssd, false);
+
+    // Título "Semaf. Intelig." no topo, centralizado
+    ssd1306_draw_string(ssd, "Semaf. Intelig.", 7, 0);
+
+    // Contador de tempo no centro
+    sprintf(time_str, "%d s", l.seconds_remaining);
+    ssd1306_draw_string(ssd, time_str, 50, 13); // Centralizado verticalmente
+
+    // Modo atual logo abaixo do contador
+    if (mode == MODE_NORMAL) {
+        sprintf(state_str, "Modo Normal");
+    } else if (mode == MODE_NOTURNO) {
+        sprintf(state_str, "Modo Noturno");
+    } else if (mode == MODE_ALTO_FLUXO) {
+        sprintf(state_str, "Alto Fluxo");
+    } else {
+        sprintf(state_str, "Baixo Fluxo");
+    }
+    ssd1306_draw_string(ssd, state_str, 25, 25); // Mantido em y=25
+
+    // Desenhar a barra como um retângulo preenchido (sem borda)
+    if (l.filled_width >= 0) {
+        for (int y = bar_y_start; y < bar_y_end; y++) {
+            ssd1306_line(ssd, bar_x_start, y, bar_x_start + l.filled_width, y, true);
+        }
+    }
+}
+
+uint32_t painel_state_key(uint8_t mode, uint8_t phase, uint32_t time_remaining_ms) {
+    painel_layout_t l = painel_layout(mode, phase, time_remaining_ms);
+    return (uint32_t)mode | ((uint32_t)l.seconds_remaining << 8) | ((uint32_t)(l.filled_width + 1) << 24);
+}
+
+uint32_t painel_next_change_ms(uint8_t phase, uint32_t time_remaining_ms) {
+    if (phase == PHASE_AMARELO || time_remaining_ms == 0) {
+        return PAINEL_MAX_SLEEP_MS; // Nada muda até a próxima troca de fase (que acorda a tarefa)
+    }
+    // O contador e a barra só mudam quando os segundos inteiros mudam, no tick
+    // seguinte a time_remaining_ms passar por um múltiplo de 1000
+    uint32_t ms = time_remaining_ms % 1000 + TICK_MS;
+    return ms < PAINEL_MAX_SLEEP_MS ? ms : PAINEL_MAX_SLEEP_MS;
+}
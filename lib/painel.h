@@ -0,0 +1,18 @@
+#ifndef PAINEL_H
+#define PAINEL_H
+
+#include "ssd1306.h"
+
+// Compõe no ram_buffer o quadro completo do display (não envia pelo I2C)
+void painel_render(ssd1306_t *ssd, uint8_t mode, uint8_t phase, uint32_t time_remaining_ms);
+
+// Governador de atualização: o quadro só é reenviado quando a chave muda
+#define PAINEL_MAX_SLEEP_MS 1000 // Maior intervalo sem reavaliar o estado
+#define PAINEL_MIN_FRAME_MS 50   // Limite de 20 quadros/s quando as mudanças chegam rápido
+
+// Chave do conteúdo visível: estados com a mesma chave geram o mesmo quadro
+uint32_t painel_state_key(uint8_t mode, uint8_t phase, uint32_t time_remaining_ms);
+// Tempo estimado até a próxima mudança visível sem eventos de fase ou modo
+uint32_t painel_next_change_ms(uint8_t phase, uint32_t time_remaining_ms);
+
+#endif
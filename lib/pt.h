@@ -0,0 +1,57 @@
+#ifndef PT_H
+#define PT_H
+
+#include <stdint.h>
+
+// Protothreads: corrotinas sem pilha no estilo de Adam Dunkels. A continuação
+// é o número da linha do último ponto de espera, guardado em pt_t, e a função
+// retoma por um switch. Custo: 2 bytes por protothread.
+//
+// Restrições: variáveis locais não sobrevivem a uma espera (use static ou o
+// contexto da protothread) e nenhum ponto de espera pode ficar dentro de um
+// switch do próprio corpo.
+
+typedef struct {
+    uint16_t lc;
+} pt_t;
+
+#define PT_ESPERANDO 0
+#define PT_CEDEU 1
+#define PT_TERMINOU 2
+
+// O ponto de espera é um case logo após uma instrução: a queda é intencional
+#if defined(__has_attribute)
+#if __has_attribute(fallthrough)
+#define PT_FALLTHROUGH __attribute__((fallthrough))
+#endif
+#endif
+#ifndef PT_FALLTHROUGH
+#define PT_FALLTHROUGH ((void)0)
+#endif
+
+#define PT_INIT(pt) ((pt)->lc = 0)
+
+#define PT_BEGIN(pt) { char pt_cedeu = 1; (void)pt_cedeu; switch ((pt)->lc) { case 0:
+
+#define PT_END(pt) } (pt)->lc = 0; return PT_TERMINOU; }
+
+// Retorna ao escalonador até a condição valer; reavaliada a cada execução
+#define PT_WAIT_UNTIL(pt, cond)              \
+    do {                                     \
+        (pt)->lc = __LINE__;                 \
+        PT_FALLTHROUGH;                      \
+        case __LINE__:                       \
+        if (!(cond)) return PT_ESPERANDO;    \
+    } while (0)
+
+// Cede a vez uma única vez e continua na próxima passada
+#define PT_YIELD(pt)                         \
+    do {                                     \
+        pt_cedeu = 0;                        \
+        (pt)->lc = __LINE__;                 \
+        PT_FALLTHROUGH;                      \
+        case __LINE__:                       \
+        if (pt_cedeu == 0) return PT_CEDEU;  \
+    } while (0)
+
+#endif
@@ -0,0 +1,94 @@
+#include "roda.h"
+#include <stddef.h>
+
+#define FATIA(ms) ((ms) & (RODA_FATIAS - 1))
+
+void roda_init(roda_t *r, uint32_t agora_ms) {
+    for (int i = 0; i < RODA_FATIAS; i++) {
+        r->fatias[i] = NULL;
+    }
+    r->agora_ms = agora_ms;
+    r->ativos = 0;
+}
+
+void roda_agendar(roda_t *r, roda_timer_t *t, uint32_t prazo_ms) {
+    if (t->ativo) {
+        roda_cancelar(r, t);
+    }
+    // Fatias já percorridas só voltam a ser vistas na próxima volta
+    if ((int32_t)(prazo_ms - r->agora_ms) <= 0) {
+        prazo_ms = r->agora_ms + 1;
+    }
+    roda_timer_t **fatia = &r->fatias[FATIA(prazo_ms)];
+    t->prazo_ms = prazo_ms;
+    t->prox = *fatia;
+    t->ativo = true;
+    *fatia = t;
+    r->ativos++;
+}
+
+void roda_cancelar(roda_t *r, roda_timer_t *t) {
+    if (!t->ativo) {
+        return;
+    }
+    for (roda_timer_t **p = &r->fatias[FATIA(t->prazo_ms)]; *p != NULL; p = &(*p)->prox) {
+        if (*p == t) {
+            *p = t->prox;
+            break;
+        }
+    }
+    t->ativo = false;
+    r->ativos--;
+}
+
+// Retira e dispara os temporizadores vencidos de uma fatia
+static void disparar_fatia(roda_t *r, uint32_t fatia, uint32_t agora_ms, roda_disparo_t disparo, void *arg) {
+    roda_timer_t **p = &r->fatias[fatia];
+    while (*p != NULL) {
+        roda_timer_t *t = *p;
+        if ((int32_t)(t->prazo_ms - agora_ms) <= 0) {
+            *p = t->prox;
+            t->ativo = false;
+            r->ativos--;
+            disparo(t, arg);
+        } else {
+            p = &t->prox;
+        }
+    }
+}
+
+void roda_avancar(roda_t *r, uint32_t agora_ms, roda_disparo_t disparo, void *arg) {
+    uint32_t decorrido = agora_ms - r->agora_ms;
+    if ((int32_t)decorrido <= 0) {
+        return;
+    }
+    // Só as fatias dos ms decorridos, e no máximo uma volta inteira
+    uint32_t passos = decorrido < RODA_FATIAS ? decorrido : RODA_FATIAS;
+    for (uint32_t i = 1; i <= passos && r->ativos > 0; i++) {
+        disparar_fatia(r, FATIA(r->agora_ms + i), agora_ms, disparo, arg);
+    }
+    r->agora_ms = agora_ms;
+}
+
+uint32_t roda_proximo_ms(const roda_t *r) {
+    if (r->ativos == 0) {
+        return RODA_SEM_PRAZO;
+    }
+    // Percorre uma volta a partir de agora: o primeiro prazo dentro da volta é o menor
+    for (uint32_t i = 1; i <= RODA_FATIAS; i++) {
+        for (const roda_timer_t *t = r->fatias[FATIA(r->agora_ms + i)]; t != NULL; t = t->prox) {
+            if (t->prazo_ms - r->agora_ms == i) {
+                return i;
+            }
+        }
+    }
+    // Todos além de uma volta
+    uint32_t menor = RODA_SEM_PRAZO;
+    for (int i = 0; i < RODA_FATIAS; i++) {
+        for (const roda_timer_t *t = r->fatias[i]; t != NULL; t = t->prox) {
+            uint32_t ms = t->prazo_ms - r->agora_ms;
+            if (ms < menor) menor = ms;
+        }
+    }
+    return menor;
+}
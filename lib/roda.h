@@ -0,0 +1,36 @@
+#ifndef RODA_H
+#define RODA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Roda de temporizadores com resolução de 1 ms: cada temporizador fica na
+// fatia prazo % RODA_FATIAS, numa lista intrusiva (sem alocação). Prazos além
+// de uma volta ficam na mesma fatia e são pulados até vencerem.
+#define RODA_FATIAS 64 // Potência de 2
+#define RODA_SEM_PRAZO UINT32_MAX
+
+typedef struct roda_timer {
+    struct roda_timer *prox;
+    uint32_t prazo_ms;
+    bool ativo;
+} roda_timer_t;
+
+typedef struct {
+    roda_timer_t *fatias[RODA_FATIAS];
+    uint32_t agora_ms; // Último instante processado
+    uint16_t ativos;
+} roda_t;
+
+typedef void (*roda_disparo_t)(roda_timer_t *t, void *arg);
+
+void roda_init(roda_t *r, uint32_t agora_ms);
+// prazo_ms é absoluto; um prazo já vencido dispara no próximo roda_avancar
+void roda_agendar(roda_t *r, roda_timer_t *t, uint32_t prazo_ms);
+void roda_cancelar(roda_t *r, roda_timer_t *t);
+// Dispara, fora de ordem dentro de cada fatia, os temporizadores vencidos até agora_ms
+void roda_avancar(roda_t *r, uint32_t agora_ms, roda_disparo_t disparo, void *arg);
+// ms do último instante processado até o próximo prazo (RODA_SEM_PRAZO se vazia)
+uint32_t roda_proximo_ms(const roda_t *r);
+
+#endif
@@ -0,0 +1,162 @@
+#include "semaforo.h"
+
+// Modo Normal: Verde (20s) -> Amarelo (3s) -> Vermelho (20s) -> Verde
+static const etapa_t etapas_normal[] = {
+    {PHASE_VERDE, 200, true},
+    {PHASE_AMARELO, 30, false},
+    {PHASE_VERMELHO, 200, true},
+};
+
+// Modo Noturno: Amarelo piscando lentamente (0.5s aceso, 1.5s apagado)
+static const etapa_t etapas_noturno[] = {
+    {PHASE_PISCANTE_ACESO, 5, true},
+    {PHASE_PISCANTE_APAGADO, 15, true},
+};
+
+// Modo Alto Fluxo: Verde (25s) -> Amarelo (3s) -> Vermelho (15s) -> Verde
+static const etapa_t etapas_alto_fluxo[] = {
+    {PHASE_VERDE, 250, true},
+    {PHASE_AMARELO, 30, false},
+    {PHASE_VERMELHO, 150, true},
+};
+
+// Modo Baixo Fluxo: Vermelho (25s) -> Amarelo (3s) -> Verde (15s) -> Vermelho
+static const etapa_t etapas_baixo_fluxo[] = {
+    {PHASE_VERMELHO, 250, true},
+    {PHASE_AMARELO, 30, false},
+    {PHASE_VERDE, 150, true},
+};
+
+#define PLANO(e) { e, sizeof(e) / sizeof(e[0]) }
+
+static const plano_t planos[NUM_MODES] = {
+    [MODE_NORMAL] = PLANO(etapas_normal),
+    [MODE_NOTURNO] = PLANO(etapas_noturno),
+    [MODE_ALTO_FLUXO] = PLANO(etapas_alto_fluxo),
+    [MODE_BAIXO_FLUXO] = PLANO(etapas_baixo_fluxo),
+};
+
+const plano_t *semaforo_plano(uint8_t mode) {
+    return &planos[mode % NUM_MODES];
+}
+
+// Recalcula fase e tempo restante a partir da etapa e do tick atuais
+static void semaforo_update(semaforo_t *s) {
+    if (s->preempcao != PREEMPCAO_NENHUMA) {
+        s->phase = s->preempcao == PREEMPCAO_LIBERANDO ? PHASE_AMARELO : PHASE_VERMELHO;
+        s->time_remaining_ms = 0; // Sem contagem: a duração depende do veículo de emergência
+        return;
+    }
+    if (s->trocando) {
+        s->phase = PHASE_AMARELO;
+        s->time_remaining_ms = 0;
+        return;
+    }
+    const etapa_t *e = &s->plano->etapas[s->etapa];
+    s->phase = e->phase;
+    s->time_remaining_ms = e->countdown ? (uint32_t)(e->ticks - s->tick) * TICK_MS : 0;
+}
+
+void semaforo_start(semaforo_t *s, uint8_t mode, const plano_t *plano) {
+    s->plano = plano;
+    s->mode = mode;
+    s->etapa = 0;
+    s->tick = 0;
+    s->preempcao = PREEMPCAO_NENHUMA;
+    s->preempcao_pedida = false;
+    s->trocando = false;
+    semaforo_update(s);
+}
+
+// Fim da preempção ou da troca de modo: o plano retoma pelo início do vermelho
+// (ou da primeira etapa, no piscante), sem voltar direto para o verde
+static void semaforo_resume(semaforo_t *s) {
+    s->preempcao = PREEMPCAO_NENHUMA;
+    s->trocando = false;
+    s->etapa = 0;
+    for (uint8_t i = 0; i < s->plano->num_etapas; i++) {
+        if (s->plano->etapas[i].phase == PHASE_VERMELHO) {
+            s->etapa = i;
+            break;
+        }
+    }
+    s->tick = 0;
+}
+
+// Avança a preempção em andamento por um tick
+static void semaforo_preempt_step(semaforo_t *s) {
+    if (s->preempcao == PREEMPCAO_LIBERANDO) {
+        // O amarelo começa entre ticks (ou logo antes do step do tick): com um
+        // tick a mais, o trecho já decorrido no primeiro não encurta os 3 s
+        if (++s->tick > PREEMPCAO_AMARELO_TICKS) {
+            s->preempcao = PREEMPCAO_RETIDO;
+            s->tick = 0;
+        }
+    } else if (!s->preempcao_pedida) {
+        semaforo_resume(s);
+    }
+}
+
+bool semaforo_preempt(semaforo_t *s, bool pedida) {
+    uint8_t last_phase = s->phase;
+    uint8_t last_preempcao = s->preempcao;
+    s->preempcao_pedida = pedida;
+
+    if (pedida && s->preempcao == PREEMPCAO_NENHUMA) {
+        if (s->phase == PHASE_VERMELHO) {
+            s->preempcao = PREEMPCAO_RETIDO;
+        } else {
+            // Amarelo do plano continua de onde está; verde e piscante começam o amarelo agora
+            s->tick = s->phase == PHASE_AMARELO ? s->tick : 0;
+            s->preempcao = PREEMPCAO_LIBERANDO;
+        }
+        s->trocando = false; // A preempção assume o amarelo; a troca recomeça depois dela
+        semaforo_update(s);
+    }
+    // No vermelho a fase não muda, mas a contagem some e a latência conta
+    return s->phase != last_phase || s->preempcao != last_preempcao;
+}
+
+// Avança um tick de TICK_MS. Uma troca de modo passa pelo amarelo de liberação
+// (exceto no vermelho) e o novo plano começa pelo vermelho. Retorna true quando
+// a fase muda.
+bool semaforo_step(semaforo_t *s, uint8_t mode) {
+    uint8_t last_phase = s->phase;
+
+    if (s->preempcao != PREEMPCAO_NENHUMA) {
+        // A troca de modo espera o fim da preempção
+        semaforo_preempt_step(s);
+        semaforo_update(s);
+        return s->phase != last_phase;
+    }
+
+    if (s->trocando) {
+        if (++s->tick >= TROCA_AMARELO_TICKS) {
+            semaforo_start(s, mode, semaforo_plano(mode));
+            semaforo_resume(s);
+        }
+        semaforo_update(s);
+        return s->phase != last_phase;
+    }
+
+    if (mode != s->mode) {
+        if (s->phase == PHASE_VERMELHO) {
+            semaforo_start(s, mode, semaforo_plano(mode)); // Já parado: o novo plano começa na hora
+            return s->phase != last_phase;
+        }
+        // Amarelo do plano continua de onde está; verde e piscante começam o amarelo agora
+        s->tick = s->phase == PHASE_AMARELO ? s->tick : 0;
+        s->trocando = true;
+        semaforo_update(s);
+        return s->phase != last_phase;
+    }
+
+    if (++s->tick >= s->plano->etapas[s->etapa].ticks) {
+        s->tick = 0;
+        if (++s->etapa >= s->plano->num_etapas) {
+            s->etapa = 0;
+        }
+    }
+    semaforo_update(s);
+    return s->phase != last_phase;
+}
@@ -0,0 +1,74 @@
+#ifndef SEMAFORO_H
+#define SEMAFORO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Modos
+#define MODE_NORMAL 0
+#define MODE_NOTURNO 1
+#define MODE_ALTO_FLUXO 2
+#define MODE_BAIXO_FLUXO 3
+#define NUM_MODES 4
+
+// Fases (0 = Verde, 1 = Amarelo, 2 = Vermelho, 3 = Amarelo Piscante Aceso, 4 = Amarelo Piscante Apagado)
+#define PHASE_VERDE 0
+#define PHASE_AMARELO 1
+#define PHASE_VERMELHO 2
+#define PHASE_PISCANTE_ACESO 3
+#define PHASE_PISCANTE_APAGADO 4
+
+// Passo do escalonador de fases (mesmo intervalo usado pelas tarefas)
+#define TICK_MS 100
+
+// Preempção por veículo de emergência: amarelo de liberação e vermelho retido
+#define PREEMPCAO_NENHUMA 0
+#define PREEMPCAO_LIBERANDO 1 // Amarelo de liberação em andamento
+#define PREEMPCAO_RETIDO 2    // Vermelho mantido enquanto a preempção for pedida
+#define PREEMPCAO_AMARELO_TICKS 30 // Mesmo amarelo dos planos (3s)
+#define TROCA_AMARELO_TICKS 30     // Amarelo de liberação antes do plano de outro modo
+
+// Uma etapa de um plano: fase exibida e duração em ticks
+typedef struct {
+    uint8_t phase;
+    uint16_t ticks;
+    bool countdown; // false = contador zerado durante a etapa (amarelo)
+} etapa_t;
+
+// Plano de tempos: sequência cíclica de etapas
+typedef struct {
+    const etapa_t *etapas;
+    uint8_t num_etapas;
+} plano_t;
+
+// Estado do escalonador de fases
+typedef struct {
+    const plano_t *plano;
+    uint8_t mode;
+    uint8_t etapa; // Índice da etapa atual no plano
+    uint8_t phase;
+    uint16_t tick; // Ticks decorridos na etapa atual
+    uint32_t time_remaining_ms;
+    uint8_t preempcao;    // PREEMPCAO_*
+    bool preempcao_pedida;
+    bool trocando;        // Amarelo de liberação da troca de modo em andamento
+} semaforo_t;
+
+const plano_t *semaforo_plano(uint8_t mode);
+void semaforo_start(semaforo_t *s, uint8_t mode, const plano_t *plano);
+bool semaforo_step(semaforo_t *s, uint8_t mode);
+// Pede ou libera a preempção. O pedido é aplicado na hora (o verde vira amarelo
+// sem esperar o próximo tick); a liberação vale ao fim do amarelo, e o plano
+// retoma pela etapa de vermelho. Retorna true quando a fase ou o estado da
+// preempção muda (um pedido no vermelho só retém o vermelho).
+bool semaforo_preempt(semaforo_t *s, bool pedida);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,111 @@
+#include "telemetria.h"
+
+static void put16(uint8_t *p, uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+}
+
+static void put32(uint8_t *p, uint32_t v) {
+    put16(p, v & 0xFFFF);
+    put16(p + 2, v >> 16);
+}
+
+static uint16_t get16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get32(const uint8_t *p) {
+    return get16(p) | ((uint32_t)get16(p + 2) << 16);
+}
+
+void telemetria_init(telemetria_t *t, uint16_t id, uint32_t agora_ms) {
+    t->ativo = 0;
+    t->lotes[0].num_eventos = 0;
+    t->lotes[1].num_eventos = 0;
+    t->id = id;
+    t->seq = 0;
+    t->descartados = 0;
+    t->falhas_envio = 0;
+    t->mode = 0;
+    t->phase = 0;
+    t->ultimo_envio_ms = agora_ms;
+    t->enviados = 0;
+}
+
+bool telemetria_evento(telemetria_t *t, uint32_t agora_ms, uint8_t mode, uint8_t phase) {
+    telemetria_lote_t *l = &t->lotes[t->ativo];
+    t->mode = mode;
+    t->phase = phase;
+    if (l->num_eventos >= TELEMETRIA_MAX_EVENTOS) {
+        if (t->descartados < UINT16_MAX) t->descartados++;
+        return false;
+    }
+    uint8_t *p = &l->dados[TELEMETRIA_CABECALHO + l->num_eventos * TELEMETRIA_EVENTO];
+    put32(p, agora_ms);
+    p[4] = mode;
+    p[5] = phase;
+    l->num_eventos++;
+    return true;
+}
+
+size_t telemetria_fechar(telemetria_t *t, uint32_t agora_ms, const uint8_t **dados) {
+    telemetria_lote_t *l = &t->lotes[t->ativo];
+    uint32_t decorrido = agora_ms - t->ultimo_envio_ms;
+    bool cheio = l->num_eventos >= TELEMETRIA_MAX_EVENTOS;
+
+    if (decorrido < TELEMETRIA_PERIODO_MS && !(cheio && decorrido >= TELEMETRIA_MIN_INTERVALO_MS)) {
+        return 0;
+    }
+
+    uint8_t *p = l->dados;
+    p[0] = 'S';
+    p[1] = 'T';
+    p[2] = TELEMETRIA_VERSAO;
+    p[3] = l->num_eventos;
+    put16(p + 4, t->id);
+    put16(p + 6, t->descartados);
+    put32(p + 8, t->seq++);
+    put32(p + 12, agora_ms);
+    put16(p + 16, t->falhas_envio);
+    p[18] = t->mode;
+    p[19] = t->phase;
+
+    // Troca de lote: os próximos eventos vão para o outro buffer
+    t->ativo ^= 1;
+    t->lotes[t->ativo].num_eventos = 0;
+    t->ultimo_envio_ms = agora_ms;
+    t->enviados++;
+
+    *dados = l->dados;
+    return TELEMETRIA_CABECALHO + (size_t)l->num_eventos * TELEMETRIA_EVENTO;
+}
+
+void telemetria_falha_envio(telemetria_t *t) {
+    if (t->falhas_envio < UINT16_MAX) t->falhas_envio++;
+}
+
+bool telemetria_decode(const uint8_t *dados, size_t len, telemetria_cabecalho_t *c) {
+    if (len < TELEMETRIA_CABECALHO || dados[0] != 'S' || dados[1] != 'T' || dados[2] != TELEMETRIA_VERSAO) {
+        return false;
+    }
+    c->num_eventos = dados[3];
+    if (c->num_eventos > TELEMETRIA_MAX_EVENTOS ||
+        len != TELEMETRIA_CABECALHO + (size_t)c->num_eventos * TELEMETRIA_EVENTO) {
+        return false;
+    }
+    c->id = get16(dados + 4);
+    c->descartados = get16(dados + 6);
+    c->seq = get32(dados + 8);
+    c->t_ms = get32(dados + 12);
+    c->falhas_envio = get16(dados + 16);
+    c->mode = dados[18];
+    c->phase = dados[19];
+    return true;
+}
+
+void telemetria_decode_evento(const uint8_t *dados, uint8_t i, telemetria_registro_t *r) {
+    const uint8_t *p = dados + TELEMETRIA_CABECALHO + i * TELEMETRIA_EVENTO;
+    r->t_ms = get32(p);
+    r->mode = p[4];
+    r->phase = p[5];
+}
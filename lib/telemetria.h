@@ -0,0 +1,86 @@
+#ifndef TELEMETRIA_H
+#define TELEMETRIA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Telemetria em lotes: eventos de modo/fase gravados direto no formato do
+// datagrama, que o transporte (UDP na placa, socket no host) envia sem cópia.
+//
+// Datagrama (little-endian):
+//   0  'S' 'T'        magic
+//   2  versão
+//   3  número de eventos
+//   4  id do armário  (16 bits)
+//   6  eventos descartados desde o boot (16 bits, satura)
+//   8  sequência do lote (32 bits): cada lote fechado consome um número
+//   12 tempo de envio (ms, 32 bits)
+//   16 envios com erro desde o boot (16 bits, satura)
+//   18 modo e fase atuais
+//   20 eventos: tempo (ms, 32 bits), modo, fase
+//
+// Um buraco na sequência é um lote que não chegou. Se o contador de erros
+// subiu o mesmo tanto, a placa não conseguiu enviar; o que sobrar se perdeu
+// no enlace. Sem lote nenhum (a cadência é fixa), a placa parou de enviar.
+
+#define TELEMETRIA_VERSAO 2
+#define TELEMETRIA_CABECALHO 20
+#define TELEMETRIA_EVENTO 6
+#define TELEMETRIA_MAX_EVENTOS 32
+#define TELEMETRIA_MAX_BYTES (TELEMETRIA_CABECALHO + TELEMETRIA_MAX_EVENTOS * TELEMETRIA_EVENTO)
+
+#define TELEMETRIA_PERIODO_MS 1000       // Cadência fixa (vai mesmo sem eventos, como sinal de vida)
+#define TELEMETRIA_MIN_INTERVALO_MS 250  // Limite de taxa: lote cheio antes da cadência espera este intervalo
+
+typedef struct {
+    uint8_t dados[TELEMETRIA_MAX_BYTES];
+    uint8_t num_eventos;
+} telemetria_lote_t;
+
+// Dois lotes: um recebe eventos enquanto o outro está com o transporte
+typedef struct {
+    telemetria_lote_t lotes[2];
+    uint8_t ativo;
+    uint16_t id;
+    uint16_t descartados;
+    uint16_t falhas_envio;
+    uint8_t mode;
+    uint8_t phase;
+    uint32_t seq;
+    uint32_t ultimo_envio_ms;
+    uint32_t enviados; // Datagramas fechados
+} telemetria_t;
+
+void telemetria_init(telemetria_t *t, uint16_t id, uint32_t agora_ms);
+// Registra uma troca de modo ou fase; false = lote cheio, evento descartado
+bool telemetria_evento(telemetria_t *t, uint32_t agora_ms, uint8_t mode, uint8_t phase);
+// Fecha o lote ativo se a cadência ou o limite de taxa permitirem. Retorna o
+// tamanho do datagrama (0 = nada a enviar) e aponta *dados para o próprio lote,
+// válido até a próxima chamada.
+size_t telemetria_fechar(telemetria_t *t, uint32_t agora_ms, const uint8_t **dados);
+// O transporte recusou o lote fechado por último; sai no cabeçalho do próximo
+void telemetria_falha_envio(telemetria_t *t);
+
+// Decodificação (coletor no host)
+typedef struct {
+    uint16_t id;
+    uint16_t descartados;
+    uint16_t falhas_envio;
+    uint32_t seq;
+    uint32_t t_ms;
+    uint8_t mode;
+    uint8_t phase;
+    uint8_t num_eventos;
+} telemetria_cabecalho_t;
+
+typedef struct {
+    uint32_t t_ms;
+    uint8_t mode;
+    uint8_t phase;
+} telemetria_registro_t;
+
+bool telemetria_decode(const uint8_t *dados, size_t len, telemetria_cabecalho_t *c);
+void telemetria_decode_evento(const uint8_t *dados, uint8_t i, telemetria_registro_t *r);
+
+#endif
@@ -0,0 +1,47 @@
+#include "telemetria_udp.h"
+#include "pico/cyw43_arch.h"
+#include "lwip/pbuf.h"
+#include "lwip/udp.h"
+
+#define TELEMETRIA_WIFI_TIMEOUT_MS 30000
+
+static struct udp_pcb *pcb = NULL;
+static ip_addr_t coletor_addr;
+static uint16_t coletor_porta;
+
+bool telemetria_udp_init(const char *ssid, const char *senha, const char *coletor, uint16_t porta) {
+    if (cyw43_arch_init()) {
+        return false;
+    }
+    cyw43_arch_enable_sta_mode();
+    if (cyw43_arch_wifi_connect_timeout_ms(ssid, senha, CYW43_AUTH_WPA2_AES_PSK, TELEMETRIA_WIFI_TIMEOUT_MS)) {
+        return false;
+    }
+    if (!ipaddr_aton(coletor, &coletor_addr)) {
+        return false;
+    }
+    coletor_porta = porta;
+
+    cyw43_arch_lwip_begin();
+    pcb = udp_new_ip_type(IPADDR_TYPE_ANY);
+    cyw43_arch_lwip_end();
+    return pcb != NULL;
+}
+
+bool telemetria_udp_send(const uint8_t *dados, size_t len) {
+    if (pcb == NULL) {
+        return false;
+    }
+    cyw43_arch_lwip_begin();
+    // O pbuf só aponta para o lote; o driver copia para o buffer do rádio dentro
+    // de udp_sendto, então o lote pode ser reutilizado assim que a chamada retorna
+    struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT, (u16_t)len, PBUF_REF);
+    err_t err = ERR_MEM;
+    if (p != NULL) {
+        p->payload = (void *)dados;
+        err = udp_sendto(pcb, p, &coletor_addr, coletor_porta);
+        pbuf_free(p);
+    }
+    cyw43_arch_lwip_end();
+    return err == ERR_OK;
+}
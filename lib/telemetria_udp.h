@@ -0,0 +1,13 @@
+#ifndef TELEMETRIA_UDP_H
+#define TELEMETRIA_UDP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Transporte UDP da telemetria pelo rádio do Pico W (lwIP)
+bool telemetria_udp_init(const char *ssid, const char *senha, const char *coletor, uint16_t porta);
+// Envia o datagrama por referência (PBUF_REF): o lote não é copiado para um pbuf
+bool telemetria_udp_send(const uint8_t *dados, size_t len);
+
+#endif
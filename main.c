@@ -1,14 +1,30 @@
 #include "pico/stdlib.h"
+#include "pico/stdio_usb.h"
 #include "hardware/gpio.h"
 #include "hardware/i2c.h"
 #include "hardware/pio.h"
 #include "ws2812.pio.h"
 #include "lib/ssd1306.h"
-#include "lib/font.h"
+#include "lib/semaforo.h"
+#include "lib/matriz.h"
+#include "lib/painel.h"
+#include "lib/audio.h"
+#include "lib/estado.h"
+#include "lib/intersecao.h"
+#include "lib/agenda.h"
+#include "lib/caixa_preta.h"
+#include "lib/energia.h"
+#if SEMAFORO_LUZ_AMBIENTE
+#include "lib/luz.h"
+#include "lib/brilho.h"
+#endif
+#if SEMAFORO_TELEMETRIA
+#include "lib/telemetria.h"
+#include "lib/telemetria_udp.h"
+#endif
 #include "FreeRTOS.h"
 #include "FreeRTOSConfig.h"
 #include "task.h"
-#include "hardware/pwm.h"
 #include <stdio.h>
 
 #define I2C_PORT i2c1
@@ -27,7 +43,6 @@
 
 // Pino para a matriz de LEDs WS2812
 #define WS2812_PIN 7
-#define NUM_LEDS 25 // Matriz 5x5 da BitDog Lab
 
 // Pinos para os buzzers
 #define BUZZER1 10
@@ -36,467 +51,608 @@
 // Pino para o botão A
 #define BUTTON_A 5
 
-// Modos
-#define MODE_NORMAL 0
-#define MODE_NOTURNO 1
-#define MODE_ALTO_FLUXO 2
-#define MODE_BAIXO_FLUXO 3
-
 // Variável global para o modo atual
 static volatile uint8_t current_mode = MODE_NORMAL;
 
-// Fase atual (0 = Verde, 1 = Amarelo, 2 = Vermelho, 3 = Amarelo Piscante Aceso, 4 = Amarelo Piscante Apagado)
-static volatile uint8_t current_phase = 0;
+// Modo, fase e tempo restante aplicados pela vMatrixLedTask, publicados juntos
+// (seqlock) para que os leitores nunca misturem campos de fases diferentes
+static estado_pub_t estado;
+
+#if SEMAFORO_INTERSECAO
+// Cruzamento: um segmento da cadeia WS2812 por grupo focal. O LED RGB, o
+// display e os buzzers acompanham o grupo principal.
+static void controle_start(uint8_t mode) { intersecao_start(mode); }
+static bool controle_step(uint8_t mode) { return intersecao_step(mode); }
+static bool controle_preempt(bool pedida) { return intersecao_preempt(pedida); }
+static bool controle_preemptado(void) { return intersecao_preemptado(); }
+static void controle_frame(uint32_t frame[NUM_LEDS]) { intersecao_compose_frame(frame); }
+
+static void controle_estado(estado_t *e) {
+    e->mode = intersecao_mode();
+    e->phase = intersecao_phase(INTERSECAO_GRUPO_PRINCIPAL);
+    e->time_remaining_ms = intersecao_time_remaining_ms();
+    if (e->phase == PHASE_AMARELO) {
+        e->time_remaining_ms = 0; // Mesmo contador zerado do semáforo simples
+    }
+}
+#else
+static semaforo_t semaforo;
+
+static void controle_start(uint8_t mode) { semaforo_start(&semaforo, mode, semaforo_plano(mode)); }
+static bool controle_step(uint8_t mode) { return semaforo_step(&semaforo, mode); }
+static bool controle_preempt(bool pedida) { return semaforo_preempt(&semaforo, pedida); }
+static bool controle_preemptado(void) { return semaforo.preempcao != PREEMPCAO_NENHUMA; }
+
+static void controle_frame(uint32_t frame[NUM_LEDS]) {
+    if (controle_preemptado()) {
+        matriz_fill_frame(frame, matriz_phase_color(semaforo.phase)); // Sem contagem na preempção
+    } else {
+        matriz_compose_frame(frame, semaforo.phase, semaforo.time_remaining_ms);
+    }
+}
+
+static void controle_estado(estado_t *e) {
+    e->mode = semaforo.mode;
+    e->phase = semaforo.phase;
+    e->time_remaining_ms = semaforo.time_remaining_ms;
+}
+#endif
 
-// Tempo restante no ciclo atual (em milissegundos)
-static volatile uint32_t time_remaining_ms = 20000;
+static void publish_controle(estado_t *e) {
+    controle_estado(e);
+    estado_publish(&estado, e);
+}
 
-// Funções auxiliares para WS2812
-static inline uint32_t rgb_to_grb(uint8_t r, uint8_t g, uint8_t b) {
-    return ((uint32_t)g << 16) | ((uint32_t)r << 8) | (uint32_t)b; // Ordem GRB
+// Entrada de preempção (veículo de emergência), ativa em nível baixo: na BitDog
+// Lab é o botão do joystick; em campo, a saída do receptor do detector.
+// Pela USB, 'E' pede e 'N' libera.
+#define PREEMPCAO_PIN 22
+static volatile bool preempcao_serial = false;
+static volatile bool preempcao_ativa = false; // Lida pelo buzzer
+
+// Latência do pedido (IRQ ou USB) até o quadro da preempção na matriz. O instante
+// do pedido tem 32 bits (time_us_32), escrito de uma vez pela IRQ; 0 = nada a medir.
+static volatile uint32_t preempcao_t0_us = 0;
+static volatile uint32_t preempcao_eventos = 0;
+static volatile uint32_t preempcao_ultima_us = 0;
+static volatile uint32_t preempcao_pior_us = 0;
+
+static bool preempcao_pedida(void) {
+    return !gpio_get(PREEMPCAO_PIN) || preempcao_serial;
 }
 
+#if SEMAFORO_LUZ_AMBIENTE
+// Nível de brilho escolhido pela matriz; o display aplica o contraste correspondente
+static volatile uint8_t contraste_oled = 0xFF;
+#endif
+
+// Contabilidade de energia por modo. Cada campo tem um único escritor: tempo e
+// matriz na vMatrixLedTask, os demais nas protothreads da vSaidasTask.
+static energia_t energia;
+
+// PIO e máquina de estado da matriz (configurados em main, antes do escalonador)
+static PIO matrix_pio = pio0;
+static uint matrix_sm;
+
+// Instantes do boot em microssegundos: sinal seguro aceso e sistema completo (display no ar).
+// 32 bits bastam (71 min) e a escrita é atômica para a vSerialTask, que imprime depois da USB.
+static volatile uint32_t boot_safe_us = 0;
+static volatile uint32_t boot_ready_us = 0;
+
+// Eventos da matriz para a tarefa de saídas (bits da notificação)
+#define SAIDA_EVT_ESTADO (1u << 0)    // Troca de fase ou de modo publicada
+#define SAIDA_EVT_PREEMPCAO (1u << 1) // Início ou fim da preempção
+#define SAIDA_EVT_CONTRASTE (1u << 2) // Novo nível de brilho
+
+// A tarefa de saídas é notificada pela matriz a cada troca de fase ou de modo;
+// a matriz é notificada pelos pedidos de preempção
+static TaskHandle_t saidas_task_handle = NULL;
+static TaskHandle_t matrix_task_handle = NULL;
+static TaskHandle_t serial_task_handle = NULL;
+
+// Estatísticas do governador do display, impressas a cada DISPLAY_STATS_MS
+#define DISPLAY_STATS_MS 60000
+
+// Funções auxiliares para WS2812
 static void ws2812_init(PIO pio, uint sm, uint pin) {
     uint offset = pio_add_program(pio, &ws2812_program);
     ws2812_program_init(pio, sm, offset, pin, 800000, false); // false = RGB, não RGBW
 }
 
-static void ws2812_set_color(PIO pio, uint sm, uint32_t color) {
+// Reset da cadeia entre quadros (> 50 us em nível baixo), mais a última palavra no OSR
+#define WS2812_LATCH_US 80
+
+// Envia um quadro completo (palavras já alinhadas) para a matriz. Espera o quadro
+// anterior terminar: o quadro da preempção pode sair logo depois do quadro do tick.
+static void ws2812_put_frame(PIO pio, uint sm, const uint32_t frame[NUM_LEDS]) {
+    while (!pio_sm_is_tx_fifo_empty(pio, sm)) {
+        tight_loop_contents();
+    }
+    busy_wait_us(WS2812_LATCH_US);
     for (int i = 0; i < NUM_LEDS; i++) {
-        pio_sm_put_blocking(pio, sm, color << 8u); // Adiciona deslocamento para alinhar os dados
+        pio_sm_put_blocking(pio, sm, frame[i]);
     }
 }
 
-// Buffer para números na matriz (0 a 9) com 5x5 pixels
-bool numeros[10][NUM_LEDS] = {
-    {0, 1, 1, 1, 0, 0, 1, 0, 1, 0, 0, 1, 0, 1, 0, 0, 1, 0, 1, 0, 0, 1, 1, 1, 0}, // 0
-    {0, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0, 1, 0, 0, 0}, // 1
-    {0, 1, 1, 1, 0, 0, 1, 0, 0, 0, 0, 1, 1, 1, 0, 0, 0, 0, 1, 0, 0, 1, 1, 1, 0}, // 2
-    {0, 1, 1, 1, 0, 0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 0, 0, 0, 1, 0, 0, 1, 1, 1, 0}, // 3
-    {0, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0, 1, 1, 1, 0, 0, 1, 0, 1, 0, 0, 1, 0, 1, 0}, // 4
-    {0, 1, 1, 1, 0, 0, 0, 0, 1, 0, 0, 1, 1, 1, 0, 0, 1, 0, 0, 0, 0, 1, 1, 1, 0}, // 5
-    {0, 1, 1, 1, 0, 0, 1, 0, 1, 0, 0, 1, 1, 1, 0, 0, 1, 0, 0, 0, 0, 1, 1, 1, 0}, // 6
-    {0, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0, 1, 1, 1, 0}, // 7
-    {0, 1, 1, 1, 0, 0, 1, 0, 1, 0, 0, 1, 1, 1, 0, 0, 1, 0, 1, 0, 0, 1, 1, 1, 0}, // 8
-    {0, 1, 1, 1, 0, 0, 0, 0, 1, 0, 0, 1, 1, 1, 0, 0, 1, 0, 1, 0, 0, 1, 1, 1, 0}  // 9
-};
-
-// Função para exibir números na matriz 5x5
-static void display_number_on_matrix(PIO pio, uint sm, int number, uint32_t color) {
-    uint32_t off = rgb_to_grb(0, 0, 0); // Desligado
-    uint32_t on = color; // Cor depende da fase (Verde ou Vermelho)
-
-    // Escolher o padrão com base no número (5 a 0 -> índices 5 a 0 do array numeros)
-    if (number < 0 || number > 5) {
-        for (int i = 0; i < NUM_LEDS; i++) {
-            pio_sm_put_blocking(pio, sm, off << 8u); // Apaga se número inválido
-        }
-        return;
+static void notify_saidas(uint32_t eventos) {
+    if (saidas_task_handle != NULL) xTaskNotify(saidas_task_handle, eventos, eSetBits);
+}
+
+// Acorda o LED RGB e o display depois de publicar um novo estado
+static void notify_outputs(void) {
+    notify_saidas(SAIDA_EVT_ESTADO);
+}
+
+// O buzzer segue a própria sequência e só é interrompido quando a preempção
+// começa ou termina
+static void sync_buzzer(void) {
+    bool ativa = controle_preemptado();
+    if (ativa != preempcao_ativa) {
+        preempcao_ativa = ativa;
+        notify_saidas(SAIDA_EVT_PREEMPCAO);
     }
+}
 
-    int pattern_index = number; // Índices 5 a 0 para os números 5 a 0
-    // Desenhar o padrão na matriz 5x5
-    for (int i = 0; i < NUM_LEDS; i++) {
-        bool pixel = numeros[pattern_index][i]; // 1 = aceso, 0 = apagado
-        pio_sm_put_blocking(pio, sm, (pixel ? on : off) << 8u);
+// Quadro aceso na matriz e desde quando, para a contabilidade de energia
+static uint32_t quadro_soma = 0;
+static uint32_t quadro_desde_ms = 0;
+
+// Envia o quadro e contabiliza o anterior pelo tempo em que ficou aceso
+static void matriz_put(PIO pio, uint sm, const uint32_t frame[NUM_LEDS], uint8_t mode) {
+    ws2812_put_frame(pio, sm, frame);
+    uint32_t agora = to_ms_since_boot(get_absolute_time());
+    energia.modo[mode].matriz_contagem_ms += (uint64_t)quadro_soma * (agora - quadro_desde_ms);
+    quadro_soma = energia_soma_quadro(frame);
+    quadro_desde_ms = agora;
+}
+
+// Aplica o nível atual da entrada de preempção. Se o controle mudar, o quadro
+// sai na hora e a latência conta desde o último pedido, tanto pela notificação
+// quanto pela reavaliação do tick (pedido chegado durante o quadro do tick).
+static bool preempcao_aplicar(PIO pio, uint sm, uint32_t frame[NUM_LEDS], estado_t *e) {
+    taskENTER_CRITICAL(); // Lê e consome o instante sem perder um pedido da IRQ
+    uint32_t t0 = preempcao_t0_us;
+    preempcao_t0_us = 0;
+    taskEXIT_CRITICAL();
+    if (!controle_preempt(preempcao_pedida())) {
+        return false;
+    }
+    controle_frame(frame);
+    matriz_put(pio, sm, frame, e->mode);
+    uint32_t latencia = 0; // Sem pedido pendente: borda perdida, achada pelo nível no tick
+    if (t0 != 0) {
+        latencia = time_us_32() - t0;
+        preempcao_ultima_us = latencia;
+        if (latencia > preempcao_pior_us) preempcao_pior_us = latencia;
+        preempcao_eventos++;
     }
+    caixa_preta_evento(CAIXA_PRETA_EVT_PREEMPCAO, controle_preemptado(), latencia < UINT16_MAX ? latencia : UINT16_MAX);
+    publish_controle(e);
+    notify_outputs();
+    return true;
 }
 
-// Tarefa para monitorar o botão A e alternar o modo
-void vButtonATask(void *pvParameters) {
+// Tarefa para controlar a matriz de LEDs WS2812 (tarefa "mestre")
+void vMatrixLedTask(void *pvParameters) {
+    PIO pio = matrix_pio;
+    uint sm = matrix_sm;
+
+    controle_start(current_mode);
+    uint32_t frame[NUM_LEDS];
+    estado_t e;
+
+    publish_controle(&e);
+#if SEMAFORO_LUZ_AMBIENTE
+    // Amostragem contínua por DMA: a tarefa só lê a média do anel a cada tick
+    luz_init();
+    brilho_t brilho;
+    brilho_init(&brilho);
+#endif
+    TickType_t proximo_tick = xTaskGetTickCount();
+
+    while (true) {
+        controle_frame(frame);
+        matriz_put(pio, sm, frame, e.mode);
+        proximo_tick += pdMS_TO_TICKS(TICK_MS);
+
+        // Espera o próximo tick; um pedido de preempção acorda a tarefa antes e
+        // é aplicado na hora, sem esperar o fim do tick
+        while (true) {
+            TickType_t espera = proximo_tick - xTaskGetTickCount();
+            if ((int32_t)espera <= 0 || ulTaskNotifyTake(pdTRUE, espera) == 0) {
+                break;
+            }
+            preempcao_aplicar(pio, sm, frame, &e);
+            sync_buzzer();
+        }
+
+        // Reavalia o nível da entrada a cada tick (bordas perdidas, trepidação ou
+        // pedido que chegou com o tick já vencido)
+        bool changed = preempcao_aplicar(pio, sm, frame, &e);
+        uint8_t last_mode = e.mode;
+        changed |= controle_step(current_mode); // Troca de modo reinicia o ciclo do novo modo
+        publish_controle(&e); // Atualiza o instantâneo antes de acordar os leitores
+        energia.modo[e.mode].tempo_ms += TICK_MS;
+        if (changed || e.mode != last_mode) {
+            caixa_preta_evento(CAIXA_PRETA_EVT_FASE, e.mode, e.phase);
+            notify_outputs();
+        }
+        sync_buzzer();
+
+#if SEMAFORO_LUZ_AMBIENTE
+        // O quadro do próximo tick já sai com a nova intensidade
+        if (brilho_update(&brilho, luz_media())) {
+            matriz_set_brilho(brilho_leds(brilho.nivel));
+            contraste_oled = brilho_contraste(brilho.nivel);
+            notify_saidas(SAIDA_EVT_CONTRASTE);
+        }
+#endif
+    }
+}
+
+// Sequenciadores de saída: protothreads da vSaidasTask (lib/agenda.h). Cada uma
+// dorme num prazo da roda de temporizadores comum ou até um evento da matriz.
+// Locais que atravessam uma espera são static (uma instância de cada).
+
+// Monitora o botão A e alterna o modo
+static int botao_pt(agenda_pt_t *p) {
+    static bool last_state;
+
+    PT_BEGIN(&p->pt);
     gpio_init(BUTTON_A);
     gpio_set_dir(BUTTON_A, GPIO_IN);
     gpio_pull_up(BUTTON_A);
 
-    bool last_state = true; // Estado inicial do botão (considerando pull-up)
+    last_state = true; // Estado inicial do botão (considerando pull-up)
     while (true) {
         bool current_state = gpio_get(BUTTON_A);
         if (last_state && !current_state) { // Detecção de borda de descida (botão pressionado)
             current_mode = (current_mode + 1) % 4; // Alterna entre 0 (Normal), 1 (Noturno), 2 (Alto Fluxo), 3 (Baixo Fluxo)
         }
         last_state = current_state;
-        vTaskDelay(pdMS_TO_TICKS(50)); // Debounce simples
+        AGENDA_ESPERAR(p, 50); // Debounce simples
     }
+    PT_END(&p->pt);
 }
 
-// Tarefa para controlar a matriz de LEDs WS2812 (tarefa "mestre")
-void vMatrixLedTask(void *pvParameters) {
-    PIO pio = pio0;
-    uint sm = pio_claim_unused_sm(pio, true); // Aloca uma máquina de estado disponível
-    ws2812_init(pio, sm, WS2812_PIN);
+// Modo em vigor pelo instantâneo publicado. Todos os periféricos são somados
+// nele, como a matriz: com uma troca pendente ou na preempção, current_mode já
+// é o modo pedido.
+static uint8_t energia_modo(void) {
+    estado_t e;
+    estado_read(&estado, &e);
+    return e.mode;
+}
 
-    while (true) {
-        if (current_mode == MODE_NORMAL) {
-            // Modo Normal: Verde (20s) -> Amarelo (3s) -> Vermelho (20s) -> Verde
-            current_phase = 0; // Verde
-            for (int i = 0; i < 200; i++) { // 20 segundos (200 * 100ms)
-                time_remaining_ms = (200 - i) * 100; // Atualiza tempo restante
-                int remaining_seconds = time_remaining_ms / 1000; // Alinha com o display
-                if (remaining_seconds > 5) { // Até 6 segundos ou mais, exibe Verde sólido
-                    ws2812_set_color(pio, sm, rgb_to_grb(0, 10, 0)); // Verde
-                } else if (remaining_seconds >= 0 && remaining_seconds <= 5) { // Últimos 6 segundos, exibe contagem 5 a 0
-                    display_number_on_matrix(pio, sm, remaining_seconds, rgb_to_grb(0, 10, 0)); // Verde
-                }
-                vTaskDelay(pdMS_TO_TICKS(100));
-                if (current_mode != MODE_NORMAL) break;
-            }
-            current_phase = 1; // Amarelo
-            for (int i = 0; i < 30; i++) { // 3 segundos (30 * 100ms)
-                time_remaining_ms = 0; // Contador zerado para amarelo
-                ws2812_set_color(pio, sm, rgb_to_grb(10, 10, 0)); // Amarelo
-                vTaskDelay(pdMS_TO_TICKS(100));
-                if (current_mode != MODE_NORMAL) break;
-            }
-            current_phase = 2; // Vermelho
-            for (int i = 0; i < 200; i++) { // 20 segundos (200 * 100ms)
-                time_remaining_ms = (200 - i) * 100; // Atualiza tempo restante
-                int remaining_seconds = time_remaining_ms / 1000; // Alinha com o display
-                if (remaining_seconds > 5) { // Até 6 segundos ou mais, exibe Vermelho sólido
-                    ws2812_set_color(pio, sm, rgb_to_grb(10, 0, 0)); // Vermelho
-                } else if (remaining_seconds >= 0 && remaining_seconds <= 5) { // Últimos 6 segundos, exibe contagem 5 a 0
-                    display_number_on_matrix(pio, sm, remaining_seconds, rgb_to_grb(10, 0, 0)); // Vermelho
-                }
-                vTaskDelay(pdMS_TO_TICKS(100));
-                if (current_mode != MODE_NORMAL) break;
-            }
-        } else if (current_mode == MODE_NOTURNO) {
-            // Modo Noturno: Amarelo piscando lentamente (restaurado para 0.5s aceso, 1.5s apagado)
-            current_phase = 3; // Amarelo Piscante Aceso
-            for (int i = 0; i < 5; i++) { // 0.5s aceso (5 * 100ms)
-                time_remaining_ms = (5 - i) * 100; // 500ms a 0ms
-                ws2812_set_color(pio, sm, rgb_to_grb(10, 10, 0)); // Amarelo
-                vTaskDelay(pdMS_TO_TICKS(100));
-                if (current_mode != MODE_NOTURNO) break;
-            }
-            current_phase = 4; // Amarelo Piscante Apagado
-            for (int i = 0; i < 15; i++) { // 1.5s apagado (15 * 100ms)
-                time_remaining_ms = (15 - i) * 100; // 1500ms a 0ms
-                ws2812_set_color(pio, sm, rgb_to_grb(0, 0, 0)); // Desligado
-                vTaskDelay(pdMS_TO_TICKS(100));
-                if (current_mode != MODE_NOTURNO) break;
-            }
-        } else if (current_mode == MODE_ALTO_FLUXO) {
-            // Modo Alto Fluxo: Verde (25s) -> Amarelo (3s) -> Vermelho (15s) -> Verde
-            current_phase = 0; // Verde
-            for (int i = 0; i < 250; i++) { // 25 segundos (250 * 100ms)
-                time_remaining_ms = (250 - i) * 100; // Atualiza tempo restante
-                int remaining_seconds = time_remaining_ms / 1000; // Alinha com o display
-                if (remaining_seconds > 5) { // Até 6 segundos ou mais, exibe Verde sólido
-                    ws2812_set_color(pio, sm, rgb_to_grb(0, 10, 0)); // Verde
-                } else if (remaining_seconds >= 0 && remaining_seconds <= 5) { // Últimos 6 segundos, exibe contagem 5 a 0
-                    display_number_on_matrix(pio, sm, remaining_seconds, rgb_to_grb(0, 10, 0)); // Verde
-                }
-                vTaskDelay(pdMS_TO_TICKS(100));
-                if (current_mode != MODE_ALTO_FLUXO) break;
-            }
-            current_phase = 1; // Amarelo
-            for (int i = 0; i < 30; i++) { // 3 segundos (30 * 100ms)
-                time_remaining_ms = 0; // Contador zerado para amarelo
-                ws2812_set_color(pio, sm, rgb_to_grb(10, 10, 0)); // Amarelo
-                vTaskDelay(pdMS_TO_TICKS(100));
-                if (current_mode != MODE_ALTO_FLUXO) break;
-            }
-            current_phase = 2; // Vermelho
-            for (int i = 0; i < 150; i++) { // 15 segundos (150 * 100ms)
-                time_remaining_ms = (150 - i) * 100; // Atualiza tempo restante
-                int remaining_seconds = time_remaining_ms / 1000; // Alinha com o display
-                if (remaining_seconds > 5) { // Até 6 segundos ou mais, exibe Vermelho sólido
-                    ws2812_set_color(pio, sm, rgb_to_grb(10, 0, 0)); // Vermelho
-                } else if (remaining_seconds >= 0 && remaining_seconds <= 5) { // Últimos 6 segundos, exibe contagem 5 a 0
-                    display_number_on_matrix(pio, sm, remaining_seconds, rgb_to_grb(10, 0, 0)); // Vermelho
-                }
-                vTaskDelay(pdMS_TO_TICKS(100));
-                if (current_mode != MODE_ALTO_FLUXO) break;
-            }
-        } else if (current_mode == MODE_BAIXO_FLUXO) {
-            // Modo Baixo Fluxo: Vermelho (25s) -> Amarelo (3s) -> Verde (15s) -> Vermelho
-            current_phase = 2; // Vermelho
-            for (int i = 0; i < 250; i++) { // 25 segundos (250 * 100ms)
-                time_remaining_ms = (250 - i) * 100; // Atualiza tempo restante
-                int remaining_seconds = time_remaining_ms / 1000; // Alinha com o display
-                if (remaining_seconds > 5) { // Até 6 segundos ou mais, exibe Vermelho sólido
-                    ws2812_set_color(pio, sm, rgb_to_grb(10, 0, 0)); // Vermelho
-                } else if (remaining_seconds >= 0 && remaining_seconds <= 5) { // Últimos 6 segundos, exibe contagem 5 a 0
-                    display_number_on_matrix(pio, sm, remaining_seconds, rgb_to_grb(10, 0, 0)); // Vermelho
-                }
-                vTaskDelay(pdMS_TO_TICKS(100));
-                if (current_mode != MODE_BAIXO_FLUXO) break;
-            }
-            current_phase = 1; // Amarelo
-            for (int i = 0; i < 30; i++) { // 3 segundos (30 * 100ms)
-                time_remaining_ms = 0; // Contador zerado para amarelo
-                ws2812_set_color(pio, sm, rgb_to_grb(10, 10, 0)); // Amarelo
-                vTaskDelay(pdMS_TO_TICKS(100));
-                if (current_mode != MODE_BAIXO_FLUXO) break;
-            }
-            current_phase = 0; // Verde
-            for (int i = 0; i < 150; i++) { // 15 segundos (150 * 100ms)
-                time_remaining_ms = (150 - i) * 100; // Atualiza tempo restante
-                int remaining_seconds = time_remaining_ms / 1000; // Alinha com o display
-                if (remaining_seconds > 5) { // Até 6 segundos ou mais, exibe Verde sólido
-                    ws2812_set_color(pio, sm, rgb_to_grb(0, 10, 0)); // Verde
-                } else if (remaining_seconds >= 0 && remaining_seconds <= 5) { // Últimos 6 segundos, exibe contagem 5 a 0
-                    display_number_on_matrix(pio, sm, remaining_seconds, rgb_to_grb(0, 10, 0)); // Verde
-                }
-                vTaskDelay(pdMS_TO_TICKS(100));
-                if (current_mode != MODE_BAIXO_FLUXO) break;
-            }
-        }
+// Acende o LED RGB e contabiliza o tempo de cada canal no estado anterior
+static void rgb_put(bool r, bool g, bool b) {
+    static bool aceso[3];
+    static uint32_t desde_ms;
+    uint32_t agora = to_ms_since_boot(get_absolute_time());
+    energia_modo_t *m = &energia.modo[energia_modo()];
+    for (int i = 0; i < 3; i++) {
+        if (aceso[i]) m->rgb_ms[i] += agora - desde_ms;
     }
+    aceso[0] = r;
+    aceso[1] = g;
+    aceso[2] = b;
+    desde_ms = agora;
+
+    gpio_put(LED_RED, r);
+    gpio_put(LED_GREEN, g);
+    gpio_put(LED_BLUE, b);
 }
 
-// Tarefa para controlar o LED RGB
-void vRgbLedTask(void *pvParameters) {
-    gpio_init(LED_RED);
-    gpio_init(LED_GREEN);
-    gpio_init(LED_BLUE);
-    gpio_set_dir(LED_RED, GPIO_OUT);
-    gpio_set_dir(LED_GREEN, GPIO_OUT);
-    gpio_set_dir(LED_BLUE, GPIO_OUT);
+// Controla o LED RGB
+static int rgb_pt(agenda_pt_t *p) {
+    PT_BEGIN(&p->pt);
+    // Pinos já configurados como saída em signal_safe_state()
 
     // Pequeno atraso inicial para sincronizar com vMatrixLedTask
-    vTaskDelay(pdMS_TO_TICKS(10));
+    AGENDA_ESPERAR(p, 10);
 
     while (true) {
-        switch (current_phase) {
+        estado_t e;
+        estado_read(&estado, &e);
+        switch (e.phase) {
             case 0: // Verde
-                gpio_put(LED_RED, false);
-                gpio_put(LED_GREEN, true);
-                gpio_put(LED_BLUE, false); // Verde
+                rgb_put(false, true, false);
                 break;
             case 1: // Amarelo (modo normal, alto fluxo, baixo fluxo)
-                gpio_put(LED_RED, true);
-                gpio_put(LED_GREEN, true);
-                gpio_put(LED_BLUE, false); // Amarelo
+                rgb_put(true, true, false);
                 break;
             case 2: // Vermelho
-                gpio_put(LED_RED, true);
-                gpio_put(LED_GREEN, false);
-                gpio_put(LED_BLUE, false); // Vermelho
+                rgb_put(true, false, false);
                 break;
             case 3: // Amarelo Piscante Aceso (modo noturno)
-                gpio_put(LED_RED, true);
-                gpio_put(LED_GREEN, true);
-                gpio_put(LED_BLUE, false); // Amarelo
+                rgb_put(true, true, false);
                 break;
             case 4: // Amarelo Piscante Apagado (modo noturno)
-                gpio_put(LED_RED, false);
-                gpio_put(LED_GREEN, false);
-                gpio_put(LED_BLUE, false); // Desligado
-                break;
             default:
-                gpio_put(LED_RED, false);
-                gpio_put(LED_GREEN, false);
-                gpio_put(LED_BLUE, false); // Desligado
+                rgb_put(false, false, false); // Desligado
                 break;
         }
-        vTaskDelay(pdMS_TO_TICKS(100)); // Sincroniza com o mesmo intervalo de vMatrixLedTask
+        AGENDA_ESPERAR(p, 100); // Mesmo intervalo de vMatrixLedTask, ou na hora da troca de fase
     }
+    PT_END(&p->pt);
+}
+
+// Conjunto de sons acessíveis deste grupo focal (chirp ou cuco)
+#define BUZZER_CONJUNTO audio_conjunto_chirp
+
+static const audio_som_t *buzzer_som;
+static uint32_t buzzer_inicio_ms;
+
+static void buzzer_tocar(const audio_som_t *som, audio_volume_t volume) {
+    audio_play(som, volume);
+    buzzer_som = som;
+    buzzer_inicio_ms = to_ms_since_boot(get_absolute_time());
+}
+
+// Encerra o bipe interrompido e contabiliza o tempo com o PWM ativo
+static void buzzer_fim(bool interrompido) {
+    if (interrompido) audio_stop();
+    uint32_t tocado = to_ms_since_boot(get_absolute_time()) - buzzer_inicio_ms;
+    uint32_t duracao = audio_duracao_ms(buzzer_som);
+    energia.modo[energia_modo()].buzzer_ms += tocado < duracao ? tocado : duracao;
+}
+
+// Toca o som e espera o período completo do bipe; as amostras saem por DMA.
+// O início ou o fim da preempção encerra o bipe na hora.
+#define BUZZER_BEEP(p, som, volume, period_ms) \
+    do {                                       \
+        buzzer_tocar((som), (volume));         \
+        AGENDA_ESPERAR((p), (period_ms));      \
+        buzzer_fim((p)->eventos != 0);         \
+    } while (0)
+
+// Sequência de um modo interrompida por troca de modo ou por preempção
+static bool buzzer_interrompido(uint8_t mode) {
+    return current_mode != mode || preempcao_ativa;
 }
 
-// Tarefa para controlar os buzzers com PWM
-void vBuzzerTask(void *pvParameters) {
-    // Configurar PWM para BUZZER1 e BUZZER2
-    gpio_set_function(BUZZER1, GPIO_FUNC_PWM);
-    gpio_set_function(BUZZER2, GPIO_FUNC_PWM);
-    uint slice_num1 = pwm_gpio_to_slice_num(BUZZER1);
-    uint slice_num2 = pwm_gpio_to_slice_num(BUZZER2);
-    pwm_set_wrap(slice_num1, 100); // Período de 100 unidades
-    pwm_set_wrap(slice_num2, 100); // Período de 100 unidades
-    pwm_set_clkdiv(slice_num1, 4.0f); // Ajustar frequência (ex.: ~5kHz com clock padrão)
-    pwm_set_clkdiv(slice_num2, 4.0f); // Ajustar frequência igual para os dois
-    pwm_set_enabled(slice_num1, true);
-    pwm_set_enabled(slice_num2, true);
+// Sequencia os sinais sonoros (apenas eventos; nenhum trabalho por amostra)
+static int buzzer_pt(agenda_pt_t *p) {
+    static const audio_conjunto_t *sons = &BUZZER_CONJUNTO;
+    static int i;
+
+    PT_BEGIN(&p->pt);
+    audio_init(BUZZER1, BUZZER2);
 
     while (true) {
-        if (current_mode == MODE_NORMAL) {
+        if (preempcao_ativa) {
+            // Preempção: tom de pare enquanto o veículo de emergência passa
+            BUZZER_BEEP(p, sons->fase[PHASE_VERMELHO], AUDIO_VOLUME_ALTO, 2000);
+        } else if (current_mode == MODE_NORMAL) {
             // Modo Normal
-            // Verde: 1 beep curto por segundo (pode atravessar)
-            for (int i = 0; i < 20; i++) { // 20 segundos
-                pwm_set_chan_level(slice_num1, pwm_gpio_to_channel(BUZZER1), 75); // 75% duty cycle
-                pwm_set_chan_level(slice_num2, pwm_gpio_to_channel(BUZZER2), 75); // 75% duty cycle
-                vTaskDelay(pdMS_TO_TICKS(200)); // Beep curto
-                pwm_set_chan_level(slice_num1, pwm_gpio_to_channel(BUZZER1), 0); // Desliga
-                pwm_set_chan_level(slice_num2, pwm_gpio_to_channel(BUZZER2), 0); // Desliga
-                vTaskDelay(pdMS_TO_TICKS(800)); // Intervalo (1s total por ciclo)
-                if (current_mode != MODE_NORMAL) break;
+            // Verde: 1 bipe por segundo (pode atravessar)
+            for (i = 0; i < 20 && !buzzer_interrompido(MODE_NORMAL); i++) { // 20 segundos
+                BUZZER_BEEP(p, sons->fase[PHASE_VERDE], AUDIO_VOLUME_ALTO, 1000);
             }
             // Amarelo: Beep rápido intermitente (atenção)
-            for (int i = 0; i < 7; i++) { // 3 segundos (7 ciclos de ~428ms)
-                pwm_set_chan_level(slice_num1, pwm_gpio_to_channel(BUZZER1), 75); // 75% duty cycle
-                pwm_set_chan_level(slice_num2, pwm_gpio_to_channel(BUZZER2), 75); // 75% duty cycle
-                vTaskDelay(pdMS_TO_TICKS(200)); // Beep rápido
-                pwm_set_chan_level(slice_num1, pwm_gpio_to_channel(BUZZER1), 0); // Desliga
-                pwm_set_chan_level(slice_num2, pwm_gpio_to_channel(BUZZER2), 0); // Desliga
-                vTaskDelay(pdMS_TO_TICKS(228)); // Intervalo ajustado para 3s totais
-                if (current_mode != MODE_NORMAL) break;
+            for (i = 0; i < 7 && !buzzer_interrompido(MODE_NORMAL); i++) { // 3 segundos (7 ciclos de ~428ms)
+                BUZZER_BEEP(p, sons->fase[PHASE_AMARELO], AUDIO_VOLUME_ALTO, 428);
             }
-            // Vermelho: Tom contínuo curto (500ms ligado, 1.5s desligado) (pare)
-            for (int i = 0; i < 10; i++) { // 20 segundos (10 ciclos de 2s)
-                pwm_set_chan_level(slice_num1, pwm_gpio_to_channel(BUZZER1), 75); // 75% duty cycle
-                pwm_set_chan_level(slice_num2, pwm_gpio_to_channel(BUZZER2), 75); // 75% duty cycle
-                vTaskDelay(pdMS_TO_TICKS(500)); // Tom contínuo
-                pwm_set_chan_level(slice_num1, pwm_gpio_to_channel(BUZZER1), 0); // Desliga
-                pwm_set_chan_level(slice_num2, pwm_gpio_to_channel(BUZZER2), 0); // Desliga
-                vTaskDelay(pdMS_TO_TICKS(1500)); // Intervalo
-                if (current_mode != MODE_NORMAL) break;
+            // Vermelho: Tom contínuo curto a cada 2s (pare)
+            for (i = 0; i < 10 && !buzzer_interrompido(MODE_NORMAL); i++) { // 20 segundos (10 ciclos de 2s)
+                BUZZER_BEEP(p, sons->fase[PHASE_VERMELHO], AUDIO_VOLUME_ALTO, 2000);
             }
         } else if (current_mode == MODE_NOTURNO) {
-            // Modo Noturno: Beep lento a cada 2s (restaurado para 0.2s aceso, 1.8s apagado)
-            pwm_set_chan_level(slice_num1, pwm_gpio_to_channel(BUZZER1), 75); // 75% duty cycle
-            pwm_set_chan_level(slice_num2, pwm_gpio_to_channel(BUZZER2), 75); // 75% duty cycle
-            vTaskDelay(pdMS_TO_TICKS(200)); // Beep curto
-            pwm_set_chan_level(slice_num1, pwm_gpio_to_channel(BUZZER1), 0); // Desliga
-            pwm_set_chan_level(slice_num2, pwm_gpio_to_channel(BUZZER2), 0); // Desliga
-            vTaskDelay(pdMS_TO_TICKS(1800)); // Intervalo de 2s
-            if (current_mode != MODE_NOTURNO) continue; // Garante que não saia do modo noturno
+            // Modo Noturno: tom localizador a cada 2s, em volume baixo
+            BUZZER_BEEP(p, sons->fase[PHASE_PISCANTE_ACESO], AUDIO_VOLUME_BAIXO, 2000);
         } else if (current_mode == MODE_ALTO_FLUXO) {
             // Modo Alto Fluxo
-            // Verde: 1 beep curto por segundo (pode atravessar)
-            for (int i = 0; i < 25; i++) { // 25 segundos
-                pwm_set_chan_level(slice_num1, pwm_gpio_to_channel(BUZZER1), 75); // 75% duty cycle
-                pwm_set_chan_level(slice_num2, pwm_gpio_to_channel(BUZZER2), 75); // 75% duty cycle
-                vTaskDelay(pdMS_TO_TICKS(200)); // Beep curto
-                pwm_set_chan_level(slice_num1, pwm_gpio_to_channel(BUZZER1), 0); // Desliga
-                pwm_set_chan_level(slice_num2, pwm_gpio_to_channel(BUZZER2), 0); // Desliga
-                vTaskDelay(pdMS_TO_TICKS(800)); // Intervalo (1s total por ciclo)
-                if (current_mode != MODE_ALTO_FLUXO) break;
+            // Verde: 1 bipe por segundo (pode atravessar)
+            for (i = 0; i < 25 && !buzzer_interrompido(MODE_ALTO_FLUXO); i++) { // 25 segundos
+                BUZZER_BEEP(p, sons->fase[PHASE_VERDE], AUDIO_VOLUME_ALTO, 1000);
             }
             // Amarelo: Beep rápido intermitente (atenção)
-            for (int i = 0; i < 7; i++) { // 3 segundos (7 ciclos de ~428ms)
-                pwm_set_chan_level(slice_num1, pwm_gpio_to_channel(BUZZER1), 75); // 75% duty cycle
-                pwm_set_chan_level(slice_num2, pwm_gpio_to_channel(BUZZER2), 75); // 75% duty cycle
-                vTaskDelay(pdMS_TO_TICKS(200)); // Beep rápido
-                pwm_set_chan_level(slice_num1, pwm_gpio_to_channel(BUZZER1), 0); // Desliga
-                pwm_set_chan_level(slice_num2, pwm_gpio_to_channel(BUZZER2), 0); // Desliga
-                vTaskDelay(pdMS_TO_TICKS(228)); // Intervalo ajustado para 3s totais
-                if (current_mode != MODE_ALTO_FLUXO) break;
+            for (i = 0; i < 7 && !buzzer_interrompido(MODE_ALTO_FLUXO); i++) { // 3 segundos (7 ciclos de ~428ms)
+                BUZZER_BEEP(p, sons->fase[PHASE_AMARELO], AUDIO_VOLUME_ALTO, 428);
             }
-            // Vermelho: Tom contínuo curto (500ms ligado, 1.5s desligado) (pare)
-            for (int i = 0; i < 7; i++) { // 15 segundos (7 ciclos de ~2.14s)
-                pwm_set_chan_level(slice_num1, pwm_gpio_to_channel(BUZZER1), 75); // 75% duty cycle
-                pwm_set_chan_level(slice_num2, pwm_gpio_to_channel(BUZZER2), 75); // 75% duty cycle
-                vTaskDelay(pdMS_TO_TICKS(500)); // Tom contínuo
-                pwm_set_chan_level(slice_num1, pwm_gpio_to_channel(BUZZER1), 0); // Desliga
-                pwm_set_chan_level(slice_num2, pwm_gpio_to_channel(BUZZER2), 0); // Desliga
-                vTaskDelay(pdMS_TO_TICKS(1643)); // Intervalo ajustado para 15s totais
-                if (current_mode != MODE_ALTO_FLUXO) break;
+            // Vermelho: Tom contínuo curto (pare)
+            for (i = 0; i < 7 && !buzzer_interrompido(MODE_ALTO_FLUXO); i++) { // 15 segundos (7 ciclos de ~2.14s)
+                BUZZER_BEEP(p, sons->fase[PHASE_VERMELHO], AUDIO_VOLUME_ALTO, 2143);
             }
         } else if (current_mode == MODE_BAIXO_FLUXO) {
             // Modo Baixo Fluxo
-            // Vermelho: Tom contínuo curto (500ms ligado, 1.5s desligado) (pare)
-            for (int i = 0; i < 12; i++) { // 25 segundos (12 ciclos de ~2.08s)
-                pwm_set_chan_level(slice_num1, pwm_gpio_to_channel(BUZZER1), 75); // 75% duty cycle
-                pwm_set_chan_level(slice_num2, pwm_gpio_to_channel(BUZZER2), 75); // 75% duty cycle
-                vTaskDelay(pdMS_TO_TICKS(500)); // Tom contínuo
-                pwm_set_chan_level(slice_num1, pwm_gpio_to_channel(BUZZER1), 0); // Desliga
-                pwm_set_chan_level(slice_num2, pwm_gpio_to_channel(BUZZER2), 0); // Desliga
-                vTaskDelay(pdMS_TO_TICKS(1583)); // Intervalo ajustado para 25s totais
-                if (current_mode != MODE_BAIXO_FLUXO) break;
+            // Vermelho: Tom contínuo curto (pare)
+            for (i = 0; i < 12 && !buzzer_interrompido(MODE_BAIXO_FLUXO); i++) { // 25 segundos (12 ciclos de ~2.08s)
+                BUZZER_BEEP(p, sons->fase[PHASE_VERMELHO], AUDIO_VOLUME_ALTO, 2083);
             }
             // Amarelo: Beep rápido intermitente (atenção)
-            for (int i = 0; i < 7; i++) { // 3 segundos (7 ciclos de ~428ms)
-                pwm_set_chan_level(slice_num1, pwm_gpio_to_channel(BUZZER1), 75); // 75% duty cycle
-                pwm_set_chan_level(slice_num2, pwm_gpio_to_channel(BUZZER2), 75); // 75% duty cycle
-                vTaskDelay(pdMS_TO_TICKS(200)); // Beep rápido
-                pwm_set_chan_level(slice_num1, pwm_gpio_to_channel(BUZZER1), 0); // Desliga
-                pwm_set_chan_level(slice_num2, pwm_gpio_to_channel(BUZZER2), 0); // Desliga
-                vTaskDelay(pdMS_TO_TICKS(228)); // Intervalo ajustado para 3s totais
-                if (current_mode != MODE_BAIXO_FLUXO) break;
+            for (i = 0; i < 7 && !buzzer_interrompido(MODE_BAIXO_FLUXO); i++) { // 3 segundos (7 ciclos de ~428ms)
+                BUZZER_BEEP(p, sons->fase[PHASE_AMARELO], AUDIO_VOLUME_ALTO, 428);
             }
-            // Verde: 1 beep curto por segundo (pode atravessar)
-            for (int i = 0; i < 15; i++) { // 15 segundos
-                pwm_set_chan_level(slice_num1, pwm_gpio_to_channel(BUZZER1), 75); // 75% duty cycle
-                pwm_set_chan_level(slice_num2, pwm_gpio_to_channel(BUZZER2), 75); // 75% duty cycle
-                vTaskDelay(pdMS_TO_TICKS(200)); // Beep curto
-                pwm_set_chan_level(slice_num1, pwm_gpio_to_channel(BUZZER1), 0); // Desliga
-                pwm_set_chan_level(slice_num2, pwm_gpio_to_channel(BUZZER2), 0); // Desliga
-                vTaskDelay(pdMS_TO_TICKS(800)); // Intervalo (1s total por ciclo)
-                if (current_mode != MODE_BAIXO_FLUXO) break;
+            // Verde: 1 bipe por segundo (pode atravessar)
+            for (i = 0; i < 15 && !buzzer_interrompido(MODE_BAIXO_FLUXO); i++) { // 15 segundos
+                BUZZER_BEEP(p, sons->fase[PHASE_VERDE], AUDIO_VOLUME_ALTO, 1000);
             }
+        } else {
+            AGENDA_ESPERAR(p, TICK_MS); // Modo desconhecido: não gira sem esperar
         }
     }
+    PT_END(&p->pt);
 }
 
-// Tarefa para o display
-void vDisplayTask(void *pvParameters) {
+#if SEMAFORO_TELEMETRIA
+// Tarefa de telemetria: acompanha o instantâneo publicado e envia os lotes por UDP.
+// Eventos com resolução de TICK_MS, sem nenhum custo na tarefa da matriz.
+void vTelemetriaTask(void *pvParameters) {
+    if (!telemetria_udp_init(TELEMETRIA_WIFI_SSID, TELEMETRIA_WIFI_SENHA, TELEMETRIA_COLETOR, TELEMETRIA_PORTA)) {
+        printf("Telemetria: falha ao conectar em %s\n", TELEMETRIA_WIFI_SSID);
+        vTaskDelete(NULL);
+    }
+
+    static telemetria_t telemetria;
+    telemetria_init(&telemetria, TELEMETRIA_ID, to_ms_since_boot(get_absolute_time()));
+    estado_t ultimo = { .mode = UINT8_MAX, .phase = UINT8_MAX };
+
+    while (true) {
+        estado_t e;
+        estado_read(&estado, &e);
+        uint32_t agora = to_ms_since_boot(get_absolute_time());
+        if (e.mode != ultimo.mode || e.phase != ultimo.phase) {
+            telemetria_evento(&telemetria, agora, e.mode, e.phase);
+            ultimo = e;
+        }
+
+        const uint8_t *dados;
+        size_t len = telemetria_fechar(&telemetria, agora, &dados);
+        if (len > 0 && !telemetria_udp_send(dados, len)) {
+            telemetria_falha_envio(&telemetria); // O coletor separa a falha daqui da perda no enlace
+        }
+        vTaskDelay(pdMS_TO_TICKS(TICK_MS));
+    }
+}
+#endif
+
+// Display: governador de quadros
+static int display_pt(agenda_pt_t *p) {
+    static ssd1306_t ssd;
+    static uint32_t last_key;
+    static TickType_t last_frame;
+    static TickType_t stats_start;
+    static uint32_t frames_sent;
+    static uint32_t preempcao_impressos;
+    static bool woke_by_event;
+    static uint32_t sleep_ms;
+    static uint32_t bytes_contados; // Parte de ssd.bytes_sent já somada à energia
+#if SEMAFORO_LUZ_AMBIENTE
+    static uint8_t contraste_aplicado;
+#endif
+
+    PT_BEGIN(&p->pt);
     i2c_init(I2C_PORT, 400 * 1000);
     gpio_set_function(I2C_SDA, GPIO_FUNC_I2C);
     gpio_set_function(I2C_SCL, GPIO_FUNC_I2C);
     gpio_pull_up(I2C_SDA);
     gpio_pull_up(I2C_SCL);
 
-    ssd1306_t ssd;
     // Inicializar o display com dimensões ajustáveis
     ssd1306_init(&ssd, DISPLAY_WIDTH, DISPLAY_HEIGHT, false, endereco, I2C_PORT);
-    ssd1306_config(&ssd);
-    ssd1306_send_data(&ssd);
-    ssd1306_fill(&ssd, false);
-    ssd1306_send_data(&ssd);
-
-    // Pequeno atraso inicial para sincronizar com vMatrixLedTask
-    vTaskDelay(pdMS_TO_TICKS(10));
-
-    char state_str[16];
-    char time_str[16];
-
-    // Definir a posição da barra
-    int bar_y_start = (DISPLAY_HEIGHT == 64) ? 40 : 20; // y=40 para 128x64, y=20 para 128x32
-    int bar_y_end = bar_y_start + 10; // Barra de 10 pixels de altura
-    int bar_width = 40; // Largura da barra
-    int bar_x_start = (DISPLAY_WIDTH - bar_width) / 2; // Centralizado: (128 - 40) / 2 = 44
+    ssd1306_config(&ssd); // Uma única transação I2C; o primeiro quadro sai logo em seguida
+
+    // Governador: o quadro só é redesenhado e enviado quando o conteúdo visível muda.
+    // A protothread dorme até a próxima mudança prevista ou até a matriz publicar um estado.
+    last_key = UINT32_MAX;
+    last_frame = 0;
+    stats_start = xTaskGetTickCount();
+    frames_sent = 0;
+    preempcao_impressos = 0;
+    woke_by_event = true;
+    bytes_contados = 0;
+#if SEMAFORO_LUZ_AMBIENTE
+    contraste_aplicado = 0xFF; // Valor de ssd1306_config
+#endif
 
     while (true) {
-        // Limpar o display completamente antes de desenhar
-        ssd1306_fill(&ssd, false);
-
-        // Título "Semaf. Intelig." no topo, centralizado
-        ssd1306_draw_string(&ssd, "Semaf. Intelig.", 7, 0);
-
-        // Contador de tempo no centro
-        int seconds_remaining = time_remaining_ms / 1000;
-        if (current_phase == 1) { // Amarelo em qualquer modo
-            seconds_remaining = 0; // Zerar o contador para amarelo
+#if SEMAFORO_LUZ_AMBIENTE
+        if (contraste_oled != contraste_aplicado) {
+            contraste_aplicado = contraste_oled;
+            ssd1306_contrast(&ssd, contraste_aplicado); // Três bytes; o quadro não é reenviado
         }
-        sprintf(time_str, "%d s", seconds_remaining);
-        ssd1306_draw_string(&ssd, time_str, 50, 13); // Centralizado verticalmente
+#endif
+        estado_t e;
+        estado_read(&estado, &e); // Instantâneo consistente de modo, fase e tempo
+        uint8_t mode = e.mode;
+        uint8_t phase = e.phase;
+        uint32_t remaining = e.time_remaining_ms;
+        uint32_t key = painel_state_key(mode, phase, remaining);
+        TickType_t now = xTaskGetTickCount();
+        sleep_ms = painel_next_change_ms(phase, remaining);
+
+        if (key != last_key) {
+            // Limita a taxa de quadros quando as mudanças chegam rápido
+            TickType_t since = now - last_frame;
+            if (last_key != UINT32_MAX && since < pdMS_TO_TICKS(PAINEL_MIN_FRAME_MS)) {
+                AGENDA_ESPERAR(p, pdTICKS_TO_MS(pdMS_TO_TICKS(PAINEL_MIN_FRAME_MS) - since));
+                continue; // Relê o estado, que pode ter mudado de novo
+            }
 
-        // Modo atual logo abaixo do contador
-        if (current_mode == MODE_NORMAL) {
-            sprintf(state_str, "Modo Normal");
-        } else if (current_mode == MODE_NOTURNO) {
-            sprintf(state_str, "Modo Noturno");
-        } else if (current_mode == MODE_ALTO_FLUXO) {
-            sprintf(state_str, "Alto Fluxo");
-        } else if (current_mode == MODE_BAIXO_FLUXO) {
-            sprintf(state_str, "Baixo Fluxo");
-        }
-        ssd1306_draw_string(&ssd, state_str, 25, 25); // Mantido em y=25
-
-        // Barra de progresso (retângulo preenchido, sem borda, apenas nos modos Normal, Alto Fluxo e Baixo Fluxo)
-        if (current_mode != MODE_NOTURNO) {
-            int filled_width = 0;
-            if (current_phase == 0 || current_phase == 2) { // Verde ou Vermelho
-                int total_time_s = 0;
-                if (current_mode == MODE_NORMAL) {
-                    total_time_s = 20; // 20s para Verde e Vermelho
-                } else if (current_mode == MODE_ALTO_FLUXO) {
-                    total_time_s = (current_phase == 0) ? 25 : 15; // 25s Verde, 15s Vermelho
-                } else if (current_mode == MODE_BAIXO_FLUXO) {
-                    total_time_s = (current_phase == 0) ? 15 : 25; // 15s Verde, 25s Vermelho
-                }
-                filled_width = (time_remaining_ms / 1000) * bar_width / total_time_s; // Proporcional ao tempo restante
+            painel_render(&ssd, mode, phase, remaining);
+            ssd1306_send_data(&ssd); // Enviar os dados para o display
+            energia.modo[mode].i2c_bytes += ssd.bytes_sent - bytes_contados; // Inclui config e contraste
+            bytes_contados = ssd.bytes_sent;
+            last_key = key;
+            last_frame = now;
+            frames_sent++;
+
+            if (preempcao_eventos != preempcao_impressos) {
+                preempcao_impressos = preempcao_eventos;
+                printf("Preempcao: %lu us (pior %lu us)\n", (unsigned long)preempcao_ultima_us,
+                       (unsigned long)preempcao_pior_us);
             }
 
-            // Desenhar a barra como um retângulo preenchido (sem borda)
-            for (int y = bar_y_start; y < bar_y_end; y++) {
-                ssd1306_line(&ssd, bar_x_start, y, bar_x_start + filled_width, y, true);
+            if (boot_ready_us == 0) {
+                boot_ready_us = time_us_32(); // Impresso pela vSerialTask, com a USB já enumerada
             }
+        } else if (!woke_by_event && remaining != 0) {
+            // Acordou antes do tick da matriz que muda os segundos: reavalia em breve
+            sleep_ms = TICK_MS / 4;
+        }
+
+        if (now - stats_start >= pdMS_TO_TICKS(DISPLAY_STATS_MS)) {
+            // Pulados = quadros que a antiga atualização fixa de 10 Hz teria enviado a mais
+            uint32_t fixed_rate_frames = pdTICKS_TO_MS(now - stats_start) / 100;
+            uint32_t skipped = fixed_rate_frames > frames_sent ? fixed_rate_frames - frames_sent : 0;
+            printf("Display: %lu quadros enviados, %lu pulados\n", (unsigned long)frames_sent, (unsigned long)skipped);
+            stats_start = now;
+            frames_sent = 0;
         }
 
-        // Enviar os dados para o display
-        ssd1306_send_data(&ssd);
-        vTaskDelay(pdMS_TO_TICKS(100)); // Sincroniza com o mesmo intervalo de vMatrixLedTask
+        AGENDA_ESPERAR(p, sleep_ms);
+        woke_by_event = p->eventos != 0;
+    }
+    PT_END(&p->pt);
+}
+
+// Janela de amostragem da CPU
+#define ENERGIA_AMOSTRA_MS 1000
+
+// Tempo de CPU fora da tarefa ociosa, pelas estatísticas de execução do kernel (µs)
+static int energia_pt(agenda_pt_t *p) {
+    static uint32_t ultimo_total_us;
+    static uint32_t ultimo_ocioso_us;
+
+    PT_BEGIN(&p->pt);
+    ultimo_total_us = time_us_32();
+    ultimo_ocioso_us = ulTaskGetIdleRunTimeCounter();
+    while (true) {
+        AGENDA_ESPERAR(p, ENERGIA_AMOSTRA_MS);
+        uint32_t total_us = time_us_32();
+        uint32_t ocioso_us = ulTaskGetIdleRunTimeCounter();
+        uint32_t janela = total_us - ultimo_total_us;
+        uint32_t ocioso = ocioso_us - ultimo_ocioso_us;
+        energia.modo[energia_modo()].cpu_ms += (janela > ocioso ? janela - ocioso : 0) / 1000;
+        ultimo_total_us = total_us;
+        ultimo_ocioso_us = ocioso_us;
+    }
+    PT_END(&p->pt);
+}
+
+// Tarefa única das saídas: botão A, LED RGB, buzzers, display e amostragem da
+// CPU como protothreads sobre uma roda de temporizadores. Dorme até o prazo
+// mais próximo ou até a matriz notificar um evento; os bits da notificação
+// dizem quem acordar.
+void vSaidasTask(void *pvParameters) {
+    static agenda_t agenda;
+    static agenda_pt_t botao, rgb, buzzer, display, cpu;
+
+    agenda_init(&agenda, pdTICKS_TO_MS(xTaskGetTickCount()));
+    agenda_add(&agenda, &botao, botao_pt, 0, "botao");
+    agenda_add(&agenda, &cpu, energia_pt, 0, "energia");
+    agenda_add(&agenda, &rgb, rgb_pt, SAIDA_EVT_ESTADO, "rgb");
+    agenda_add(&agenda, &buzzer, buzzer_pt, SAIDA_EVT_PREEMPCAO, "buzzer");
+    // Por último: o envio de um quadro (~25 ms de I2C) não atrasa os bipes da mesma passada
+    agenda_add(&agenda, &display, display_pt, SAIDA_EVT_ESTADO | SAIDA_EVT_CONTRASTE, "display");
+
+    uint32_t eventos = 0;
+    while (true) {
+        uint32_t espera_ms = agenda_executar(&agenda, pdTICKS_TO_MS(xTaskGetTickCount()), eventos);
+        TickType_t espera = espera_ms == RODA_SEM_PRAZO ? portMAX_DELAY : pdMS_TO_TICKS(espera_ms);
+        eventos = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &eventos, espera);
     }
 }
 
@@ -504,25 +660,160 @@ void vDisplayTask(void *pvParameters) {
 #include "pico/bootrom.h"
 #define botaoB 6
 void gpio_irq_handler(uint gpio, uint32_t events) {
+    if (gpio == PREEMPCAO_PIN) {
+        // Preempção: acorda a matriz (prioridade mais alta), que aplica o pedido na hora
+        preempcao_t0_us = time_us_32();
+        if (matrix_task_handle != NULL) {
+            BaseType_t woken = pdFALSE;
+            vTaskNotifyGiveFromISR(matrix_task_handle, &woken);
+            portYIELD_FROM_ISR(woken);
+        }
+        return;
+    }
     reset_usb_boot(0, 0);
 }
 
+// Chegada de caracteres pela USB (contexto de interrupção)
+static void serial_chars_available(void *param) {
+    if (serial_task_handle != NULL) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(serial_task_handle, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+// Consumo estimado por modo, a partir dos contadores acumulados desde o boot
+static void energia_relatorio(void) {
+    static energia_t copia;
+    taskENTER_CRITICAL();
+    copia = energia;
+    taskEXIT_CRITICAL();
+
+    for (uint8_t mode = 0; mode < NUM_MODES; mode++) {
+        const energia_modo_t *m = &copia.modo[mode];
+        energia_consumo_t c;
+        if (!energia_consumo(m, &c)) continue;
+        printf("Energia %s: %lu.%lu mAh/h em %lu s (uA: base %lu cpu %lu matriz %lu rgb %lu buzzer %lu i2c %lu oled %lu)\n",
+               energia_nome_modo(mode), (unsigned long)(c.total_ua / 1000), (unsigned long)(c.total_ua % 1000 / 100),
+               (unsigned long)(m->tempo_ms / 1000), (unsigned long)c.base_ua, (unsigned long)c.cpu_ua,
+               (unsigned long)c.matriz_ua, (unsigned long)c.rgb_ua, (unsigned long)c.buzzer_ua,
+               (unsigned long)c.i2c_ua, (unsigned long)c.oled_ua);
+        // Ciclo ativo em milésimos; a matriz em relação a todos os canais em 255
+        uint32_t cpu = energia_permil(m->cpu_ms, m->tempo_ms);
+        uint32_t matriz = energia_permil(m->matriz_contagem_ms, (uint64_t)m->tempo_ms * NUM_LEDS * 3 * 255);
+        uint32_t buzzer = energia_permil(m->buzzer_ms, m->tempo_ms);
+        printf("  ativo: cpu %lu.%lu%% matriz %lu.%lu%% buzzer %lu.%lu%% rgb %lu/%lu/%lu ms, i2c %lu B/s\n",
+               (unsigned long)(cpu / 10), (unsigned long)(cpu % 10), (unsigned long)(matriz / 10),
+               (unsigned long)(matriz % 10), (unsigned long)(buzzer / 10), (unsigned long)(buzzer % 10),
+               (unsigned long)m->rgb_ms[0], (unsigned long)m->rgb_ms[1], (unsigned long)m->rgb_ms[2],
+               (unsigned long)((uint64_t)m->i2c_bytes * 1000 / m->tempo_ms));
+    }
+}
+
+static void boot_imprimir(void) {
+    printf("Boot: sinal seguro em %lu us, operacao completa em %lu us\n", (unsigned long)boot_safe_us,
+           (unsigned long)boot_ready_us);
+}
+
+// Folga mínima da pilha desta tarefa, impressa depois dos relatórios (printf pesa na pilha)
+static void pilha_imprimir(void) {
+    printf("Serial: pilha livre minima %lu palavras\n", (unsigned long)uxTaskGetStackHighWaterMark(NULL));
+}
+
+// Espera máxima pelo terminal USB antes de imprimir a caixa preta do boot anterior
+#define CAIXA_PRETA_USB_MS 5000
+
+// Tarefa para os comandos pela USB: 'E' pede a preempção, 'N' libera, 'D'
+// imprime os tempos de boot e a caixa preta (boot anterior e eventos do boot
+// atual) e 'P' o consumo estimado por modo
+void vSerialTask(void *pvParameters) {
+    stdio_set_chars_available_callback(serial_chars_available, NULL);
+    for (int i = 0; i < CAIXA_PRETA_USB_MS / 100 && !stdio_usb_connected(); i++) {
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+    while (boot_ready_us == 0) { // Primeiro quadro do display, ~100 ms após o reset
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    boot_imprimir();
+    caixa_preta_dump(false); // Comandos que chegarem antes ficam na notificação pendente
+    pilha_imprimir();
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        int c;
+        while ((c = getchar_timeout_us(0)) != PICO_ERROR_TIMEOUT) {
+            if (c == 'D' || c == 'd') {
+                boot_imprimir();
+                caixa_preta_dump(true);
+                pilha_imprimir();
+            } else if (c == 'P' || c == 'p') {
+                energia_relatorio();
+                pilha_imprimir();
+            } else if (c == 'E' || c == 'e' || c == 'N' || c == 'n') {
+                preempcao_serial = (c == 'E' || c == 'e');
+                preempcao_t0_us = time_us_32();
+                xTaskNotifyGive(matrix_task_handle);
+            }
+        }
+    }
+}
+
+// Estado seguro imediatamente após o reset (inclusive após brown-out): vermelho
+// no LED RGB e na matriz, antes do USB, do display e do escalonador.
+static void signal_safe_state(void) {
+    gpio_init(LED_RED);
+    gpio_init(LED_GREEN);
+    gpio_init(LED_BLUE);
+    gpio_put(LED_RED, true); // Nível definido antes de virar saída, sem pulso apagado
+    gpio_put(LED_GREEN, false);
+    gpio_put(LED_BLUE, false);
+    gpio_set_dir(LED_RED, GPIO_OUT);
+    gpio_set_dir(LED_GREEN, GPIO_OUT);
+    gpio_set_dir(LED_BLUE, GPIO_OUT);
+
+    matrix_sm = pio_claim_unused_sm(matrix_pio, true); // Aloca uma máquina de estado disponível
+    ws2812_init(matrix_pio, matrix_sm, WS2812_PIN);
+    uint32_t frame[NUM_LEDS];
+    matriz_fill_frame(frame, matriz_phase_color(PHASE_VERMELHO));
+    ws2812_put_frame(matrix_pio, matrix_sm, frame);
+    estado_t e = { .mode = current_mode, .phase = PHASE_VERMELHO, .time_remaining_ms = 0 };
+    estado_publish(&estado, &e);
+
+    boot_safe_us = time_us_32();
+}
+
 int main() {
+    // Primeiro as luzes: o restante da inicialização é adiado
+    signal_safe_state();
+    // Guarda o registro do boot anterior antes de qualquer novo evento
+    caixa_preta_iniciar(&estado);
+
     // Para o modo BOOTSEL com botão B
     gpio_init(botaoB);
     gpio_set_dir(botaoB, GPIO_IN);
     gpio_pull_up(botaoB);
     gpio_set_irq_enabled_with_callback(botaoB, GPIO_IRQ_EDGE_FALL, true, &gpio_irq_handler);
 
+    // Entrada de preempção: as duas bordas acordam a matriz (pedido e liberação)
+    gpio_init(PREEMPCAO_PIN);
+    gpio_set_dir(PREEMPCAO_PIN, GPIO_IN);
+    gpio_pull_up(PREEMPCAO_PIN);
+    gpio_set_irq_enabled(PREEMPCAO_PIN, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true);
+
     stdio_init_all();
 
     // Criação das tarefas
-    xTaskCreate(vButtonATask, "Button A Task", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY + 2, NULL);
-    xTaskCreate(vMatrixLedTask, "Matrix LED Task", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL);
-    xTaskCreate(vRgbLedTask, "RGB LED Task", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL);
-    xTaskCreate(vBuzzerTask, "Buzzer Task", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL);
-    xTaskCreate(vDisplayTask, "Display Task", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL);
+    // A matriz tem prioridade sobre o display: a inicialização do OLED nunca atrasa as luzes
+    // e a preempção é atendida assim que a notificação chega. Só ela fica no topo: os
+    // despejos da serial (printf na USB) não dividem a fatia de tempo com a preempção.
+    xTaskCreate(vMatrixLedTask, "Matrix LED Task", configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY + 3, &matrix_task_handle);
+    xTaskCreate(vSerialTask, "Serial Task", 2 * configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY + 2, &serial_task_handle);
+    // Botão, LED RGB, buzzers e display numa só tarefa; pilha dobrada para o printf e o painel
+    xTaskCreate(vSaidasTask, "Saidas Task", 2 * configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, &saidas_task_handle);
+#if SEMAFORO_TELEMETRIA
+    // Pilha maior: a inicialização do rádio e a conexão rodam nesta tarefa
+    xTaskCreate(vTelemetriaTask, "Telemetria Task", 4 * configMINIMAL_STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, NULL);
+#endif
 
     vTaskStartScheduler();
-    panic_unsupported();
+    panic_unsupported(); // Registrado na caixa preta, que reinicia a placa
 }
\ No newline at end of file
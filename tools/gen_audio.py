@@ -0,0 +1,62 @@
+#!/usr/bin/env python3
+"""Gera lib/audio_samples.h com as tabelas de amostras dos sinais sonoros.
+
+As amostras são níveis de PWM de 8 bits (0..254, repouso em 127) guardados
+como uint16_t, porque o DMA escreve meia palavra no registrador CC do PWM.
+
+    python3 tools/gen_audio.py > lib/audio_samples.h
+"""
+import math
+
+SENO_LEN = 64          # Um período; potência de 2 para o anel de leitura do DMA
+CHIRP_RATE = 16000     # Amostras/s do chirp
+CHIRP_MS = 150
+CHIRP_F0, CHIRP_F1 = 3200.0, 1800.0  # Varredura descendente (Hz)
+
+
+def level(x):
+    return max(0, min(254, int(round(127 + 127 * x))))
+
+
+def table(name, values, attrs=""):
+    out = [f"static const uint16_t {name}[{len(values)}]{attrs} = {{"]
+    for i in range(0, len(values), 16):
+        out.append("    " + ", ".join(str(v) for v in values[i:i + 16]) + ",")
+    out.append("};")
+    return "\n".join(out)
+
+
+def main():
+    seno = [level(math.sin(2 * math.pi * i / SENO_LEN)) for i in range(SENO_LEN)]
+
+    n = CHIRP_RATE * CHIRP_MS // 1000
+    chirp, phase = [], 0.0
+    for i in range(n):
+        t = i / n
+        f = CHIRP_F0 * (CHIRP_F1 / CHIRP_F0) ** t        # Varredura exponencial
+        phase += 2 * math.pi * f / CHIRP_RATE
+        env = math.sin(math.pi * t) ** 0.5               # Ataque e decaimento suaves
+        chirp.append(level(env * math.sin(phase)))
+
+    print("// Gerado por tools/gen_audio.py. Não edite à mão.")
+    print("#ifndef AUDIO_SAMPLES_H")
+    print("#define AUDIO_SAMPLES_H")
+    print()
+    print("#include <stdint.h>")
+    print()
+    print(f"#define AUDIO_SENO_LEN {SENO_LEN}")
+    print(f"#define AUDIO_CHIRP_LEN {n}")
+    print(f"#define AUDIO_CHIRP_RATE {CHIRP_RATE}")
+    print(f"#define AUDIO_CHIRP_MS {CHIRP_MS}")
+    print()
+    print("// Um período de seno; alinhado ao próprio tamanho para o anel de leitura do DMA")
+    print(table("audio_seno", seno, f" __attribute__((aligned({SENO_LEN * 2})))"))
+    print()
+    print(f"// Chirp: {CHIRP_F0:.0f} Hz -> {CHIRP_F1:.0f} Hz em {CHIRP_MS} ms")
+    print(table("audio_chirp", chirp))
+    print()
+    print("#endif")
+
+
+if __name__ == "__main__":
+    main()